@@ -0,0 +1,94 @@
+#include "FingerprintSampler.hpp"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <queue>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <stdexcept>
+
+using namespace std;
+
+/**
+ * micro benchmark of the selection of the fingerprints for clustering.
+ * generates num_blocks random fingerprints (written like in the workloads: a leading space and 16 hex digits), selects
+ * the num_fps smallest ones using the previous selection (a priority queue of <fingerprint string, sn>) and using
+ * FingerprintSampler, and reports the time of both
+ *
+ * usage: fingerprint_selection_benchmark [num_blocks (default 5000000)] [num_fps, or 'all' (default 1000)]
+ */
+
+static vector<pair<int, string>> selectWithStringQueue(const vector<string>& fingerprints, const int num_fps){
+    priority_queue<pair<string, int>> minhash_fingerprints;
+    for (int block_sn = 0; block_sn < fingerprints.size(); ++block_sn) {
+        const string& fingerprint = fingerprints[block_sn];
+        if (num_fps == FingerprintSampler::NO_LIMIT || minhash_fingerprints.size() < num_fps) {
+            minhash_fingerprints.push(make_pair(fingerprint, block_sn));
+            continue;
+        }
+
+        if (minhash_fingerprints.top().first.compare(fingerprint) > 0) {
+            minhash_fingerprints.pop();
+            minhash_fingerprints.push(make_pair(fingerprint, block_sn));
+        }
+    }
+
+    vector<pair<int, string>> selected;
+    while (!minhash_fingerprints.empty()) {
+        selected.emplace_back(minhash_fingerprints.top().second, minhash_fingerprints.top().first);
+        minhash_fingerprints.pop();
+    }
+
+    sort(selected.begin(), selected.end());
+    return selected;
+}
+
+static vector<pair<int, string>> selectWithSampler(const vector<string>& fingerprints, const int num_fps){
+    FingerprintSampler fingerprint_sampler(num_fps);
+    for (int block_sn = 0; block_sn < fingerprints.size(); ++block_sn) {
+        const string& fingerprint = fingerprints[block_sn];
+        fingerprint_sampler.addFingerprint(block_sn, fingerprint.data(), fingerprint.data() + fingerprint.size());
+    }
+
+    return fingerprint_sampler.getSelectedOrderedBySN();
+}
+
+int main(int argc, char **argv) {
+    const int num_blocks = argc > 1 ? stoi(argv[1]) : 5000000;
+    const int num_fps = argc <= 2 ? 1000 : string(argv[2]) == "all" ? FingerprintSampler::NO_LIMIT : stoi(argv[2]);
+
+    mt19937_64 generator(0);
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    vector<string> fingerprints;
+    fingerprints.reserve(num_blocks);
+    for (int i = 0; i < num_blocks; ++i) {
+        string fingerprint(" ");
+        const uint64_t value = generator();
+        for (int digit = 15; digit >= 0; --digit)
+            fingerprint += HEX_DIGITS[(value >> (digit * 4)) & 0xf];
+        fingerprints.emplace_back(move(fingerprint));
+    }
+
+    using clock = chrono::high_resolution_clock;
+    const auto queue_start_time = clock::now();
+    const vector<pair<int, string>> queue_selected = selectWithStringQueue(fingerprints, num_fps);
+    const clock::duration queue_duration = clock::now() - queue_start_time;
+
+    const auto sampler_start_time = clock::now();
+    const vector<pair<int, string>> sampler_selected = selectWithSampler(fingerprints, num_fps);
+    const clock::duration sampler_duration = clock::now() - sampler_start_time;
+
+    if (queue_selected != sampler_selected)
+        throw runtime_error("the sampler selection differs from the string priority queue selection");
+
+    const double queue_ms = chrono::duration<double, milli>(queue_duration).count();
+    const double sampler_ms = chrono::duration<double, milli>(sampler_duration).count();
+    cout << "blocks=" << num_blocks << ",fps=" << (num_fps == FingerprintSampler::NO_LIMIT ? string("all") : to_string(num_fps)) << endl;
+    cout << "string priority queue: " << queue_ms << " ms" << endl;
+    cout << "fingerprint sampler: " << sampler_ms << " ms" << endl;
+    cout << "speedup: " << queue_ms / sampler_ms << "x" << endl;
+
+    return EXIT_SUCCESS;
+}
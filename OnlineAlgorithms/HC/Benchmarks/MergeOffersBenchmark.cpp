@@ -0,0 +1,116 @@
+#include "Utility.hpp"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdexcept>
+
+using namespace std;
+
+/**
+ * micro benchmark of the bounded top-K selection of merge offers.
+ * a single merge of a system with num_files files considers every pair of its lower triangle once, this benchmark
+ * selects the max_results_size smallest offers out of such a scan using the previous selection (sort after every
+ * insert) and using Utility::updateBoundedMaxHeap, and reports the time per merge of both
+ *
+ * usage: merge_offers_benchmark [num_files (default 2000)] [max_results_size (default 10)] [num_merges (default 5)]
+ */
+
+struct MergeOffer final{
+    double weighted_dissimilarity;
+    int cluster1;
+    int cluster2;
+};
+
+static bool sortDesc(const MergeOffer& a, const MergeOffer& b){
+    if(a.weighted_dissimilarity != b.weighted_dissimilarity)
+        return a.weighted_dissimilarity > b.weighted_dissimilarity;
+
+    if(a.cluster1 != b.cluster1)
+        return a.cluster1 > b.cluster1;
+
+    return a.cluster2 > b.cluster2;
+}
+
+static bool sortAsc(const MergeOffer& a, const MergeOffer& b){
+    return sortDesc(b, a);
+}
+
+static void updateSortedOffers(vector<MergeOffer>& sorted_offers, const int max_results_size, const MergeOffer& offer){
+    if (sorted_offers.size() >= max_results_size &&
+        offer.weighted_dissimilarity >= sorted_offers.front().weighted_dissimilarity)
+        return;
+
+    if (sorted_offers.size() < max_results_size)
+        sorted_offers.push_back(offer);
+    else
+        sorted_offers.front() = offer;
+
+    sort(sorted_offers.begin(), sorted_offers.end(), sortDesc);
+}
+
+static void updateHeapOffers(vector<MergeOffer>& heap_offers, const int max_results_size, const MergeOffer& offer){
+    if (heap_offers.size() >= max_results_size &&
+        offer.weighted_dissimilarity >= heap_offers.front().weighted_dissimilarity)
+        return;
+
+    Utility::updateBoundedMaxHeap(heap_offers, max_results_size, offer, sortAsc);
+}
+
+template<typename UpdateFunc>
+static vector<MergeOffer> selectSmallestOffers(const vector<vector<double>>& distances, const int max_results_size,
+                                               UpdateFunc update_func){
+    vector<MergeOffer> offers;
+    offers.reserve(max_results_size);
+
+    for (int i = 0; i < distances.size(); ++i) {
+        for (int j = 0; j < i; ++j)
+            update_func(offers, max_results_size, {distances[i][j], i, j});
+    }
+
+    sort(offers.begin(), offers.end(), sortAsc);
+    return offers;
+}
+
+int main(int argc, char **argv) {
+    const int num_files = argc > 1 ? stoi(argv[1]) : 2000;
+    const int max_results_size = argc > 2 ? stoi(argv[2]) : 10;
+    const int num_merges = argc > 3 ? stoi(argv[3]) : 5;
+
+    // distances are drawn from a small set of values, so ties on the weighted dissimilarity are common
+    mt19937 generator(0);
+    uniform_int_distribution<int> distance_distribution(0, 1000);
+    vector<vector<double>> distances(num_files);
+    for (int i = 0; i < num_files; ++i) {
+        for (int j = 0; j < i; ++j)
+            distances[i].push_back(distance_distribution(generator) / 1000.0);
+    }
+
+    using clock = chrono::high_resolution_clock;
+    clock::duration sort_duration(0);
+    clock::duration heap_duration(0);
+    for (int merge = 0; merge < num_merges; ++merge) {
+        const auto sort_start_time = clock::now();
+        const vector<MergeOffer> sorted_offers = selectSmallestOffers(distances, max_results_size, updateSortedOffers);
+        sort_duration += clock::now() - sort_start_time;
+
+        const auto heap_start_time = clock::now();
+        const vector<MergeOffer> heap_offers = selectSmallestOffers(distances, max_results_size, updateHeapOffers);
+        heap_duration += clock::now() - heap_start_time;
+
+        for (int i = 0; i < sorted_offers.size(); ++i) {
+            if (sortAsc(sorted_offers[i], heap_offers[i]) || sortAsc(heap_offers[i], sorted_offers[i]))
+                throw runtime_error("the heap selection differs from the sort selection");
+        }
+    }
+
+    const double sort_ms = chrono::duration<double, milli>(sort_duration).count() / num_merges;
+    const double heap_ms = chrono::duration<double, milli>(heap_duration).count() / num_merges;
+    cout << "files=" << num_files << ",max_results_size=" << max_results_size << ",merges=" << num_merges << endl;
+    cout << "sort per insert: " << sort_ms << " ms per merge" << endl;
+    cout << "bounded max heap: " << heap_ms << " ms per merge" << endl;
+    cout << "speedup: " << sort_ms / heap_ms << "x" << endl;
+
+    return EXIT_SUCCESS;
+}
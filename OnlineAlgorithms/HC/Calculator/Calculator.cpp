@@ -19,8 +19,8 @@ namespace Calculator {
     }
 
     static vector<shared_ptr<VolumeCalcInfo>> getVolumesCost(const vector<string>& sorted_volumes_names,
-                                                             const vector<vector<bool>> &appearances_matrix,
-                                                             const map<int, int>& block_to_size,
+                                                             const FileBlocksIndex &file_blocks_index,
+                                                             const vector<int>& block_to_size,
                                                              const map<string, set<int>>& initial_system_clustering,
                                                              const map<string, set<int>>& final_system_clustering,
                                                              const map<string, set<int>>& added_files_per_vol,
@@ -44,7 +44,7 @@ namespace Calculator {
 
             volumes_info.emplace_back(make_shared<VolumeCalcInfo>(vol_name, volume_initial_files,
                                                                   volume_final_files, added_files, removed_files,
-                                                                  appearances_matrix, block_to_size,
+                                                                  file_blocks_index, block_to_size,
                                                                   use_cache, cache_path));
         }
 
@@ -154,8 +154,8 @@ namespace Calculator {
     }
 
     static shared_ptr<Calculator::CostResult> getCalculateCost(
-            const vector<string>& sorted_volumes_names, const vector<vector<bool>> &appearances_matrix,
-            const map<int, int>& block_to_size, const map<string, set<int>>& initial_system_clustering,
+            const vector<string>& sorted_volumes_names, const FileBlocksIndex &file_blocks_index,
+            const vector<int>& block_to_size, const map<string, set<int>>& initial_system_clustering,
             const map<string, set<int>>& final_system_clustering,
             const map<string, set<int>>& change_added_file_per_vol,
             const map<string, set<int>>& change_removed_file_per_vol,
@@ -169,7 +169,7 @@ namespace Calculator {
             const string& cache_path){
 
         const vector<shared_ptr<VolumeCalcInfo>> volumes_info =
-                getVolumesCost(sorted_volumes_names, appearances_matrix, block_to_size, initial_system_clustering,
+                getVolumesCost(sorted_volumes_names, file_blocks_index, block_to_size, initial_system_clustering,
                                final_system_clustering, change_added_file_per_vol, change_removed_file_per_vol,
                                use_cache, cache_path);
 
@@ -206,7 +206,7 @@ namespace Calculator {
     }
 
     shared_ptr<Calculator::CostResult> getClusteringCost(const bool is_change,
-            const bool use_cache, const vector<vector<bool>> &appearances_matrix,  const map<int, int>& block_to_size,
+            const bool use_cache, const FileBlocksIndex &file_blocks_index,  const vector<int>& block_to_size,
             const map<string, set<int>>& initial_system_clustering,
             const map<string, set<int>>& final_system_clustering,
             const map<string, set<int>>& change_added_files_per_vol,
@@ -237,7 +237,7 @@ namespace Calculator {
         vector<long long int> init_vol_sizes, vol_traffics, vol_deletions, vol_receive_bytes, vol_overlap_traffic,
                 vol_block_reuse, vol_aborted_traffic;
         shared_ptr<Calculator::CostResult> cost_result =
-                getCalculateCost(sorted_volumes_names, appearances_matrix, block_to_size, initial_system_clustering,
+                getCalculateCost(sorted_volumes_names, file_blocks_index, block_to_size, initial_system_clustering,
                                  final_system_clustering, change_added_files_per_vol,
                                  change_removed_files_per_vol,
                                  allowed_traffic_bytes, margin, load_balance, lb_sizes,
@@ -54,7 +54,7 @@ namespace Calculator {
     };
 
     shared_ptr<Calculator::CostResult> getClusteringCost(const bool is_change,
-            const bool use_cache, const vector<vector<bool>> &appearances_matrix, const map<int, int>& block_to_size,
+            const bool use_cache, const FileBlocksIndex &file_blocks_index, const vector<int>& block_to_size,
             const map<string, set<int>>& initial_system_clustering, const map<string, set<int>>& final_system_clustering,
             const map<string, set<int>>& changes_added_files_per_vol,
             const map<string, set<int>>& changes_removed_files_per_vol,
@@ -6,8 +6,8 @@
 
 map<string, VolumeCalcInfo> VolumeCalcInfo::_cache;
 VolumeCalcInfo::VolumeCalcInfo(string  volume_name, const set<int> &initial_files, const set<int> &final_files,
-                               const set<int> &added_files, const set<int> &removed_files, const vector<vector<bool>> &appearances_matrix,
-                               const map<int, int>& block_to_size, const bool use_cache, const string& cache_path) :
+                               const set<int> &added_files, const set<int> &removed_files, const FileBlocksIndex &file_blocks_index,
+                               const vector<int>& block_to_size, const bool use_cache, const string& cache_path) :
         m_volume_name(std::move(volume_name)),
         m_init_volume_size(0),
         m_received_bytes(0),
@@ -17,7 +17,7 @@ VolumeCalcInfo::VolumeCalcInfo(string  volume_name, const set<int> &initial_file
         m_mig_reuse_blocks_spare_traffic_bytes(0),
         m_migration_aborted_traffic(0)
 {
-    initializeVolumeCalculations(appearances_matrix, initial_files, final_files, added_files, removed_files, block_to_size, use_cache,
+    initializeVolumeCalculations(file_blocks_index, initial_files, final_files, added_files, removed_files, block_to_size, use_cache,
                                  cache_path);
 }
 
@@ -56,10 +56,10 @@ std::string VolumeCalcInfo::getMemoryCacheKey(const std::string& vol_name, const
     "-" + added_files_hash + "-" + removed_files_hash));
 }
 
-void VolumeCalcInfo::initializeVolumeCalculations(const vector<vector<bool>> &appearances_matrix,
+void VolumeCalcInfo::initializeVolumeCalculations(const FileBlocksIndex &file_blocks_index,
                                                   const set<int> &initial_files, const set<int> &final_files,
                                                   const set<int> &added_files, const set<int> &removed_files,
-                                                  const map<int, int> &block_to_size,
+                                                  const vector<int> &block_to_size,
                                                   const bool use_cache, const string& cache_path) {
 
     // ----------------- start of cache -----------------
@@ -94,23 +94,23 @@ void VolumeCalcInfo::initializeVolumeCalculations(const vector<vector<bool>> &ap
     }
     // --------- End Get State Before Changes ----------
 
-    const set<int> init_without_removed_files = getBlocksInFiles(appearances_matrix, init_files_with_remove_changes);
-    const set<int> final_without_changes = getBlocksInFiles(appearances_matrix, final_files_without_changes);
-    const set<int> initial_files_blocks = getBlocksInFiles(appearances_matrix, initial_files);
-    const set<int> final_files_blocks = getBlocksInFiles(appearances_matrix, final_files);
-    const set<int> add_by_change_files_blocks = getBlocksInFiles(appearances_matrix, added_files);
+    const set<int> init_without_removed_files = getBlocksInFiles(file_blocks_index, init_files_with_remove_changes);
+    const set<int> final_without_changes = getBlocksInFiles(file_blocks_index, final_files_without_changes);
+    const set<int> initial_files_blocks = getBlocksInFiles(file_blocks_index, initial_files);
+    const set<int> final_files_blocks = getBlocksInFiles(file_blocks_index, final_files);
+    const set<int> add_by_change_files_blocks = getBlocksInFiles(file_blocks_index, added_files);
 
     // Go over to find the initial size and deleted bytes
     for(const int initial_files_block : initial_files_blocks){
-        m_init_volume_size += block_to_size.at(initial_files_block);
+        m_init_volume_size += block_to_size[initial_files_block];
 
         if(final_files_blocks.find(initial_files_block) == final_files_blocks.cend())
-            m_num_bytes_deleted += block_to_size.at(initial_files_block);
+            m_num_bytes_deleted += block_to_size[initial_files_block];
     }
 
     for(const int final_files_block : final_without_changes) {
         if(initial_files_blocks.find(final_files_block) != initial_files_blocks.cend()){
-            const long long block_size = block_to_size.at(final_files_block);
+            const long long block_size = block_to_size[final_files_block];
             bool exists_init_no_removed_files = init_without_removed_files.find(final_files_block) != init_without_removed_files.cend();
             if(!exists_init_no_removed_files && final_files_blocks.find(final_files_block) != final_files_blocks.cend()){
                 //  A block is reused by migration if:
@@ -120,7 +120,7 @@ void VolumeCalcInfo::initializeVolumeCalculations(const vector<vector<bool>> &ap
             continue;
         }
 
-        const long long block_size = block_to_size.at(final_files_block);
+        const long long block_size = block_to_size[final_files_block];
         if(final_files_blocks.find(final_files_block) == final_files_blocks.cend()){
             //  A block is aborted in middle of transfer if:
             //     exists in final files without changes && not exists in init state && not exists in final state
@@ -148,7 +148,7 @@ void VolumeCalcInfo::initializeVolumeCalculations(const vector<vector<bool>> &ap
             continue;
         }
 
-        const long long block_size = block_to_size.at(final_files_block);
+        const long long block_size = block_to_size[final_files_block];
         m_received_bytes += block_size;
     }
 
@@ -161,22 +161,23 @@ void VolumeCalcInfo::initializeVolumeCalculations(const vector<vector<bool>> &ap
     // ----------------- End of cache -----------------
 }
 
-set<int> VolumeCalcInfo::getBlocksInFiles(const vector<vector<bool>> &appearances_matrix, const set<int>& file_indices){
+set<int> VolumeCalcInfo::getBlocksInFiles(const FileBlocksIndex &file_blocks_index, const set<int>& file_indices){
     set<int> blocks_in_files;
     for(const int file_index: file_indices){
-        const set<int> blocks_in_file = getBlocksInFile(appearances_matrix, file_index);
-        blocks_in_files.insert(blocks_in_file.cbegin(), blocks_in_file.cend());
+        file_blocks_index.forEachBlockInFile(file_index, [&blocks_in_files](const int block_index){
+            blocks_in_files.insert(block_index);
+        });
     }
 
     return std::move(blocks_in_files);
 }
 
-set<int> VolumeCalcInfo::getBlocksInFile(const vector<vector<bool>> &appearances_matrix, const int file_index) {
+set<int> VolumeCalcInfo::getBlocksInFile(const FileBlocksIndex &file_blocks_index, const int file_index) {
+    // the blocks are enumerated in ascending order, so every insert is at the end of the set
     set<int> blocks_in_file;
-    for(int block_index=0; block_index < appearances_matrix[file_index].size(); ++block_index){
-        if(appearances_matrix[file_index][block_index])
-            blocks_in_file.insert(block_index);
-    }
+    file_blocks_index.forEachBlockInFile(file_index, [&blocks_in_file](const int block_index){
+        blocks_in_file.insert(blocks_in_file.cend(), block_index);
+    });
 
-    return std::move(blocks_in_file);
+    return blocks_in_file;
 }
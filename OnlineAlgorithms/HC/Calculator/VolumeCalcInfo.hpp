@@ -1,5 +1,7 @@
 #pragma once
 
+#include "FileBlocksIndex.hpp"
+
 #include <string>
 #include <set>
 #include <vector>
@@ -12,8 +14,8 @@ public:
     static constexpr char* const MEMORY_CACHE_PATH = "!memory_cache!";
 public:
     explicit VolumeCalcInfo(string  volume_name, const set<int>& initial_files, const set<int>& final_files,
-                            const set<int>& added_files, const set<int>& removed_files, const vector<vector<bool>> &appearances_matrix,
-                            const map<int, int>& block_to_size, const bool use_cache, const string& cache_path);
+                            const set<int>& added_files, const set<int>& removed_files, const FileBlocksIndex &file_blocks_index,
+                            const vector<int>& block_to_size, const bool use_cache, const string& cache_path);
 
     explicit VolumeCalcInfo(string  volume_name, const  long long int init_volume_size,
                             const long long int received_bytes, const  long long int delete_bytes,
@@ -34,14 +36,14 @@ public:
     long long int getOverlapTrafficBytes() const {return m_overlap_mig_changes_traffic;}
     long long int getBlockReuseBytes() const {return m_mig_reuse_blocks_spare_traffic_bytes;}
     long long int getAbortedTrafficBytes() const {return m_migration_aborted_traffic;}
-    static set<int> getBlocksInFiles(const vector<vector<bool>> &appearances_matrix, const set<int>& file_indices);
-    static set<int> getBlocksInFile(const vector<vector<bool>> &appearances_matrix, const int file_index);
+    static set<int> getBlocksInFiles(const FileBlocksIndex &file_blocks_index, const set<int>& file_indices);
+    static set<int> getBlocksInFile(const FileBlocksIndex &file_blocks_index, const int file_index);
 
 private:
-    void initializeVolumeCalculations(const vector<vector<bool>> &appearances_matrix,
+    void initializeVolumeCalculations(const FileBlocksIndex &file_blocks_index,
                                       const set<int> &initial_files, const set<int> &final_files,
                                       const set<int> &added_files, const set<int> &removed_files,
-                                      const map<int, int>& block_to_size, const bool use_cache, const string& cache_path);
+                                      const vector<int>& block_to_size, const bool use_cache, const string& cache_path);
 
 private:
     static std::string getMemoryCacheKey(const std::string& vol_name, const std::set<int>& init_files,
@@ -11,24 +11,15 @@
 #include <utility>
 #include <chrono>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <climits>
+#include <numeric>
 
 using namespace std;
 
 vector<HierarchicalClustering::resultCompareFunc> HierarchicalClustering::ClusteringResult::sort_order = vector<HierarchicalClustering::resultCompareFunc>();
 
-struct HierarchicalClustering::ClustersMergeOffer final{
-public:
-    ClustersMergeOffer(double weighted_dissimilarity, int cluster1, int cluster2):
-            weighted_dissimilarity(weighted_dissimilarity), cluster1(cluster1), cluster2(cluster2)
-    {
-    }
-
-public:
-    double weighted_dissimilarity;
-    int cluster1;
-    int cluster2;
-};
-
 int HierarchicalClustering::ClusteringResult::compareDeletion(const shared_ptr <ClusteringResult> &res1,
                                                               const shared_ptr <ClusteringResult> &res2) {
     if(res1->cost_result->deletion_percentage > res2->cost_result->deletion_percentage)
@@ -103,63 +94,346 @@ bool HierarchicalClustering::ClusteringResult::sortResultDesc(const shared_ptr<H
 
 HierarchicalClustering::HierarchicalClustering(
         std::unique_ptr<AlgorithmDSManager>&  ds,
-        const vector<double> &lb_sizes):
+        const vector<double> &lb_sizes,
+        const int num_threads,
+        const bool resume_failed_clusterings,
+        const int num_speculative_margins,
+        const int warm_start_percent,
+        const bool use_super_nodes,
+        const double super_nodes_jaccard_threshold,
+        const bool refine_super_nodes,
+        const bool validate_dissimilarities_precision,
+        const int sweep_budget_percent,
+        const bool validate_sweep_budget):
         m_lb_sizes(lb_sizes),
-        m_current_system_size(0),
-        m_ds(ds.release())
+        m_ds(ds.release()),
+        m_num_threads(std::max(num_threads, 1)),
+        m_resume_failed_clusterings(resume_failed_clusterings),
+        m_num_speculative_margins(std::max(num_speculative_margins, 1)),
+        m_warm_start_percent(warm_start_percent),
+        m_use_super_nodes(use_super_nodes),
+        m_super_nodes_jaccard_threshold(super_nodes_jaccard_threshold),
+        m_refine_super_nodes(refine_super_nodes),
+        m_validate_dissimilarities_precision(validate_dissimilarities_precision),
+        m_sweep_budget_percent(sweep_budget_percent),
+        m_validate_sweep_budget(validate_sweep_budget),
+        m_num_validated_sweeps(0),
+        m_num_surviving_best_results(0)
 {
-    initClusters();
 }
 
-void HierarchicalClustering::initClusters(){
-    // if only need to reset, no new file was added to the system. otherwise we'll calc again
-    if(m_clusters.size() == m_ds->getNumberOfFilesForClustering())
-    {
-        m_current_system_size = 0;
-        for(const auto& node : m_clusters){
-            if(m_ds->isFileRemoved(*node->getCurrentFiles().begin())){
-                node->disableNode();
-                m_ds->deactivateClusterInDissimilarityMat(*node->getCurrentFiles().begin());
-                continue;
-            }
+constexpr int HierarchicalClustering::NO_WARM_START;
+constexpr int HierarchicalClustering::FULL_SWEEP_BUDGET;
+constexpr int HierarchicalClustering::NO_MAX_INDEX;
+constexpr int HierarchicalClustering::PrecisionValidation::NO_DIFFERENT_MERGE;
+
+constexpr int HierarchicalClustering::ClusteringWorkspace::NO_OVERLAY_ROW;
+constexpr int HierarchicalClustering::ClusteringWorkspace::DEACTIVATED_CLUSTER;
+constexpr int HierarchicalClustering::ClusteringWorkspace::NOT_ACTIVE_CLUSTER;
+const AlgorithmDSManager::DissimilarityCell HierarchicalClustering::ClusteringWorkspace::DEACTIVATED_CELL(DBL_MAX);
+
+std::vector<AlgorithmDSManager::DissimilarityCell>& HierarchicalClustering::ClusteringWorkspace::getOverlayRow(
+        const int cluster_index){
+    markClusterModified(cluster_index);
+    if (cluster_overlay_row[cluster_index] >= 0)
+        return overlay_rows[cluster_overlay_row[cluster_index]];
+
+    // the overlay row starts with the cluster's current cells
+    const int overlay_row = allocateOverlayRow();
+    std::vector<AlgorithmDSManager::DissimilarityCell>& row_cells = overlay_rows[overlay_row];
+    row_cells.resize(cluster_overlay_row.size());
+    for (int i = 0; i < row_cells.size(); ++i)
+        row_cells[i] = getDissimilarityCell(cluster_index, i);
+
+    cluster_overlay_row[cluster_index] = overlay_row;
+    return row_cells;
+}
 
-            node->reset();
-            m_current_system_size+= node->getSize();
-        }
+HierarchicalClustering::ClusteringWorkspace::CandidateCells&
+HierarchicalClustering::ClusteringWorkspace::getCandidateOverlayRow(const int cluster_index){
+    markClusterModified(cluster_index);
+    if (cluster_overlay_row[cluster_index] >= 0)
+        return candidate_overlay_rows[cluster_overlay_row[cluster_index]];
+
+    // the overlay row starts with the cluster's current cells
+    const int overlay_row = allocateOverlayRow();
+    CandidateCells& row_cells = candidate_overlay_rows[overlay_row];
+    row_cells.clear();
+    const auto add_cell = [&row_cells](const int j, const AlgorithmDSManager::DissimilarityCell& cell){
+        row_cells.emplace_back(j, cell);
+    };
+    forEachActiveCandidateCell(cluster_index, cluster_overlay_row.size(), add_cell);
+
+    cluster_overlay_row[cluster_index] = overlay_row;
+    return row_cells;
+}
+
+int HierarchicalClustering::ClusteringWorkspace::allocateOverlayRow(){
+    if (!free_overlay_rows.empty()) {
+        const int overlay_row = free_overlay_rows.back();
+        free_overlay_rows.pop_back();
+        return overlay_row;
+    }
+
+    if (useCandidateCells()) {
+        candidate_overlay_rows.emplace_back();
+        return candidate_overlay_rows.size() - 1;
+    }
+
+    overlay_rows.emplace_back();
+    return overlay_rows.size() - 1;
+}
+
+void HierarchicalClustering::ClusteringWorkspace::deactivateClusterInDissimilarityMat(const int cluster_index){
+    markClusterModified(cluster_index);
+    releaseOverlayRow(cluster_index);
+    cluster_overlay_row[cluster_index] = DEACTIVATED_CLUSTER;
+    removeActiveCluster(cluster_index);
+}
+
+void HierarchicalClustering::ClusteringWorkspace::addActiveCluster(const int cluster_index){
+    if (active_cluster_position[cluster_index] != NOT_ACTIVE_CLUSTER)
+        return;
+
+    active_cluster_position[cluster_index] = active_clusters.size();
+    active_clusters.push_back(cluster_index);
+}
+
+void HierarchicalClustering::ClusteringWorkspace::removeActiveCluster(const int cluster_index){
+    const int position = active_cluster_position[cluster_index];
+    if (position == NOT_ACTIVE_CLUSTER)
+        return;
+
+    const int last_cluster = active_clusters.back();
+    active_clusters[position] = last_cluster;
+    active_cluster_position[last_cluster] = position;
+    active_clusters.pop_back();
+    active_cluster_position[cluster_index] = NOT_ACTIVE_CLUSTER;
+}
+
+void HierarchicalClustering::ClusteringWorkspace::markClusterModified(const int cluster_index){
+    if (is_cluster_modified[cluster_index])
+        return;
+
+    is_cluster_modified[cluster_index] = true;
+    modified_clusters.push_back(cluster_index);
+}
 
+void HierarchicalClustering::ClusteringWorkspace::releaseOverlayRow(const int cluster_index){
+    if (cluster_overlay_row[cluster_index] < 0)
         return;
+
+    free_overlay_rows.push_back(cluster_overlay_row[cluster_index]);
+    cluster_overlay_row[cluster_index] = NO_OVERLAY_ROW;
+}
+
+void HierarchicalClustering::ClusteringWorkspace::saveCheckpoint(const RandomGenerator& checkpoint_random_generator,
+                                                                 const int num_current_clusters){
+    checkpoint.is_valid = true;
+    checkpoint.num_current_clusters = num_current_clusters;
+    checkpoint.current_system_size = current_system_size;
+    checkpoint.random_generator = checkpoint_random_generator;
+
+    checkpoint.modified_clusters = modified_clusters;
+    checkpoint.modified_clusters_nodes.clear();
+    checkpoint.modified_clusters_size_from_origin_clusters.clear();
+    checkpoint.modified_clusters_blocks = BitMatrix(modified_clusters.size(), cluster_blocks.getNumColumns());
+    checkpoint.overlay_rows_indices.clear();
+    int num_saved_overlay_rows = 0;
+    for (int i = 0; i < modified_clusters.size(); ++i) {
+        const int cluster = modified_clusters[i];
+        checkpoint.modified_clusters_nodes.push_back(std::make_shared<const Node>(*clusters[cluster]));
+        checkpoint.modified_clusters_size_from_origin_clusters.push_back(size_from_origin_clusters[cluster]);
+        checkpoint.modified_clusters_blocks.copyRow(i, cluster_blocks, cluster);
+
+        // only modified clusters have overlay rows
+        if (cluster_overlay_row[cluster] < 0)
+            continue;
+
+        if (useCandidateCells()) {
+            if (checkpoint.candidate_overlay_rows.size() == num_saved_overlay_rows)
+                checkpoint.candidate_overlay_rows.emplace_back();
+            const CandidateCells& overlay_row = candidate_overlay_rows[cluster_overlay_row[cluster]];
+            checkpoint.candidate_overlay_rows[num_saved_overlay_rows++] = overlay_row;
+        } else {
+            if (checkpoint.overlay_rows.size() == num_saved_overlay_rows)
+                checkpoint.overlay_rows.emplace_back();
+            checkpoint.overlay_rows[num_saved_overlay_rows++] = overlay_rows[cluster_overlay_row[cluster]];
+        }
+        checkpoint.overlay_rows_indices.push_back(cluster_overlay_row[cluster]);
     }
 
-    m_clusters = std::vector<std::unique_ptr<Node>>(m_ds->getNumberOfFilesForClustering());
+    checkpoint.num_overlay_rows = getNumberOfOverlayRows();
+    checkpoint.cluster_overlay_row = cluster_overlay_row;
+    checkpoint.free_overlay_rows = free_overlay_rows;
+    checkpoint.active_clusters_sizes = active_clusters_sizes;
+    checkpoint.active_clusters = active_clusters;
+    checkpoint.active_cluster_position = active_cluster_position;
+    checkpoint.row_merge_offers = row_merge_offers;
+    checkpoint.is_row_merge_offers_complete = is_row_merge_offers_complete;
+    checkpoint.merges = merges;
+}
 
-    m_current_system_size = 0;
-    // create a node for each file with its size
-    for (int i = 0; i < m_clusters.size(); ++i) {
-        const double cluster_size = getClusterSize({i});
-        m_clusters[i] = std::make_unique<Node>(i, cluster_size);
+void HierarchicalClustering::ClusteringWorkspace::restoreCheckpoint(){
+    // the clusters which were modified only after the checkpoint are back to their initial state
+    for (const int cluster : modified_clusters)
+        is_cluster_modified[cluster] = false;
+    for (const int cluster : checkpoint.modified_clusters)
+        is_cluster_modified[cluster] = true;
+    for (const int cluster : modified_clusters) {
+        if (is_cluster_modified[cluster])
+            continue;
+
+        clusters[cluster]->reset();
+        size_from_origin_clusters[cluster] = getLeafSizeFromOriginClusters(cluster);
+        cluster_blocks.copyRow(cluster, getLeavesBlocks(), cluster);
+    }
 
-        if(m_ds->isFileRemoved(i)){
-            m_clusters[i]->disableNode();
-            m_ds->deactivateClusterInDissimilarityMat(i);
+    modified_clusters = checkpoint.modified_clusters;
+    for (int i = 0; i < modified_clusters.size(); ++i) {
+        const int cluster = modified_clusters[i];
+        clusters[cluster] = std::make_unique<Node>(*checkpoint.modified_clusters_nodes[i]);
+        size_from_origin_clusters[cluster] = checkpoint.modified_clusters_size_from_origin_clusters[i];
+        cluster_blocks.copyRow(cluster, checkpoint.modified_clusters_blocks, i);
+    }
+
+    // the overlay rows which were created after the checkpoint are free (the checkpoint may be of another workspace,
+    // which created more overlay rows)
+    if (useCandidateCells()) {
+        if (candidate_overlay_rows.size() < checkpoint.num_overlay_rows)
+            candidate_overlay_rows.resize(checkpoint.num_overlay_rows);
+        for (int i = 0; i < checkpoint.overlay_rows_indices.size(); ++i)
+            candidate_overlay_rows[checkpoint.overlay_rows_indices[i]] = checkpoint.candidate_overlay_rows[i];
+    } else {
+        if (overlay_rows.size() < checkpoint.num_overlay_rows)
+            overlay_rows.resize(checkpoint.num_overlay_rows);
+        for (int i = 0; i < checkpoint.overlay_rows_indices.size(); ++i)
+            overlay_rows[checkpoint.overlay_rows_indices[i]] = checkpoint.overlay_rows[i];
+    }
+    cluster_overlay_row = checkpoint.cluster_overlay_row;
+    free_overlay_rows = checkpoint.free_overlay_rows;
+    for (int i = checkpoint.num_overlay_rows; i < getNumberOfOverlayRows(); ++i)
+        free_overlay_rows.push_back(i);
+
+    current_system_size = checkpoint.current_system_size;
+    random_generator = checkpoint.random_generator;
+    active_clusters_sizes = checkpoint.active_clusters_sizes;
+    active_clusters = checkpoint.active_clusters;
+    active_cluster_position = checkpoint.active_cluster_position;
+    row_merge_offers = checkpoint.row_merge_offers;
+    is_row_merge_offers_complete = checkpoint.is_row_merge_offers_complete;
+    merges = checkpoint.merges;
+}
+
+void HierarchicalClustering::initClusters(ClusteringWorkspace& workspace){
+    workspace.clusters = std::vector<std::unique_ptr<Node>>(workspace.getNumberOfLeaves());
+
+    workspace.current_system_size = 0;
+    workspace.active_clusters_sizes.clear();
+    workspace.active_clusters.clear();
+    workspace.active_cluster_position.assign(workspace.clusters.size(), ClusteringWorkspace::NOT_ACTIVE_CLUSTER);
+    // create a node for each file (or super node) with its size
+    for (int i = 0; i < workspace.clusters.size(); ++i) {
+        if (workspace.super_nodes) {
+            workspace.clusters[i] = std::make_unique<Node>(workspace.super_nodes->getFiles(i),
+                                                           workspace.super_nodes->getSize(i));
+        } else {
+            workspace.clusters[i] = std::make_unique<Node>(i, getFileBlocksSize(i));
+        }
+
+        const double cluster_size = workspace.clusters[i]->getSize();
+
+        // the super nodes have no removed files
+        if(!workspace.super_nodes && m_ds->isFileRemoved(i)){
+            workspace.clusters[i]->disableNode();
+            workspace.deactivateClusterInDissimilarityMat(i);
             continue;
         }
 
-        m_current_system_size += cluster_size;
+        workspace.current_system_size += cluster_size;
+        workspace.active_clusters_sizes.emplace(cluster_size, i);
+        workspace.addActiveCluster(i);
+    }
+}
+
+void HierarchicalClustering::rollbackModifiedClusters(ClusteringWorkspace& workspace){
+    for (const int cluster : workspace.modified_clusters) {
+        if (workspace.clusters[cluster]->isActivated())
+            workspace.active_clusters_sizes.erase({workspace.clusters[cluster]->getSize(), cluster});
+
+        workspace.clusters[cluster]->reset();
+        workspace.active_clusters_sizes.emplace(workspace.clusters[cluster]->getSize(), cluster);
+
+        workspace.releaseOverlayRow(cluster);
+        workspace.cluster_overlay_row[cluster] = ClusteringWorkspace::NO_OVERLAY_ROW;
+        workspace.is_cluster_modified[cluster] = false;
+        workspace.size_from_origin_clusters[cluster] = workspace.getLeafSizeFromOriginClusters(cluster);
+        workspace.cluster_blocks.copyRow(cluster, workspace.getLeavesBlocks(), cluster);
+    }
+
+    workspace.modified_clusters.clear();
+    workspace.current_system_size = workspace.initial_system_size;
+
+    // the active clusters are rebuilt in ascending order (as after initClusters), so the scans of the next execution
+    // read the rows of the dissimilarities matrix sequentially
+    workspace.active_clusters.clear();
+    for (int i = 0; i < workspace.clusters.size(); ++i) {
+        workspace.active_cluster_position[i] = ClusteringWorkspace::NOT_ACTIVE_CLUSTER;
+        if (workspace.clusters[i]->isActivated())
+            workspace.addActiveCluster(i);
     }
 }
 
 HierarchicalClustering::ClustersMergeOffer HierarchicalClustering::findBestMerge(
-        const ClusteringParams& clustering_params, const int num_current_clusters,
-        const int num_files_for_clustering){
+        const ClusteringParams& clustering_params, ClusteringWorkspace& workspace, bool& is_merge_restricted){
 
+    is_merge_restricted = false;
     vector<ClustersMergeOffer> sorted_merge_offers;
     sorted_merge_offers.reserve(clustering_params.max_results_size);
 
-    // iterate the lower triangular of the matrix and find our maximum values
-    for (int i = 0; i < m_ds->getNumberOfFilesForClustering(); i++) {
-        for (int j = 0; j < i; j++) {
-            updateSortedMergeOffers(clustering_params, sorted_merge_offers, i, j, num_current_clusters,
-                                    num_files_for_clustering);
+    // every row keeps its merge offers in ascending order, so the smallest merge offers of the whole matrix are
+    // collected by repeatedly taking the smallest head out of a min heap of the rows' heads (row, position in row)
+    const auto is_greater_head = [&workspace](const pair<int, int>& head1, const pair<int, int>& head2){
+        return sortDesc(workspace.row_merge_offers[head1.first][head1.second],
+                        workspace.row_merge_offers[head2.first][head2.second]);
+    };
+
+    vector<pair<int, int>> rows_heads;
+    rows_heads.reserve(workspace.active_clusters.size());
+    for (const int i : workspace.active_clusters) {
+        if (!workspace.row_merge_offers[i].empty())
+            rows_heads.emplace_back(i, 0);
+    }
+
+    make_heap(rows_heads.begin(), rows_heads.end(), is_greater_head);
+    while (!rows_heads.empty()) {
+        pop_heap(rows_heads.begin(), rows_heads.end(), is_greater_head);
+        const int row = rows_heads.back().first;
+        const int next_position = rows_heads.back().second + 1;
+        const ClustersMergeOffer merge_offer = workspace.row_merge_offers[row][rows_heads.back().second];
+        rows_heads.pop_back();
+
+        // in case we are using load balance and the new sizes in case of a merge are invalid
+        if (!clustering_params.load_balance ||
+            isValidClustersMerge(clustering_params, workspace, merge_offer.cluster1, merge_offer.cluster2)) {
+            sorted_merge_offers.push_back(merge_offer);
+            if (sorted_merge_offers.size() == clustering_params.max_results_size)
+                break;
+        } else {
+            is_merge_restricted = true;
+        }
+
+        // the row holds only its best offers and its last one is next, the rest of the row is fetched ahead of its scan
+        if (next_position + 1 == workspace.row_merge_offers[row].size() && !workspace.is_row_merge_offers_complete[row])
+            workspace.prefetchLeavesRows(row, row + 1);
+
+        // the row holds only its best offers and all of them were already taken, fetch the rest of the row
+        if (next_position == workspace.row_merge_offers[row].size() && !workspace.is_row_merge_offers_complete[row])
+            calcRowMergeOffers(clustering_params, workspace, row, true);
+
+        if (next_position < workspace.row_merge_offers[row].size()) {
+            rows_heads.emplace_back(row, next_position);
+            push_heap(rows_heads.begin(), rows_heads.end(), is_greater_head);
         }
     }
 
@@ -167,48 +441,181 @@ HierarchicalClustering::ClustersMergeOffer HierarchicalClustering::findBestMerge
     if (sorted_merge_offers.size() == 0)
         return {-1, -1, -1};
 
-    // sort them in *ascending* order
-    sort(sorted_merge_offers.begin(), sorted_merge_offers.end(), HierarchicalClustering::sortAsc);
-
-    return randClustersMergeOfferFromVector(sorted_merge_offers, clustering_params.gap);
+    // the offers are already sorted in *ascending* order
+    return randClustersMergeOfferFromVector(sorted_merge_offers, clustering_params.gap, workspace.random_generator);
 }
 
-void HierarchicalClustering::updateSortedMergeOffers(
-        const ClusteringParams& clustering_params,
-        vector<ClustersMergeOffer>&  sorted_merge_offers,
-        const int cluster1,
-        const int cluster2,
-        const int num_current_clusters,
-        const int num_files_for_clustering)
+void HierarchicalClustering::updateSortedMergeOffers(vector<ClustersMergeOffer>& sorted_merge_offers,
+                                                     const int max_results_size,
+                                                     const ClustersMergeOffer& merge_offer)
 {
-    // if one of the given cluster is invalid there is no need to update the sorted dissimilarities values
-    if(m_ds->getDissimilarityCell(cluster1, cluster2).jaccard_distance == DBL_MAX)
+    // in case we already collect max_results_size values and this value is greater than our max value, we will not
+    // consider inserting it to our "best" dissimilarities solution cache. the offers are compared by their full order
+    // (not only by the dissimilarity) since they are not visited in a fixed order
+    if (sorted_merge_offers.size() >= max_results_size && !sortAsc(merge_offer, sorted_merge_offers.front()))
         return;
 
-    const double current_clusters_distance = getDistanceBetweenClusters(clustering_params, cluster1, cluster2);
+    // keep the offers as a max heap by the same order as sortDesc, so the max value stays at front
+    Utility::updateBoundedMaxHeap(sorted_merge_offers, max_results_size, merge_offer, HierarchicalClustering::sortAsc);
+}
 
-    const double current_weighted_dissimilarity = current_clusters_distance;
-    // in case we already collect max_results_size values and this value is greater than our max value, we will not
-    // consider inserting it to our "best" dissimilarities solution cache
-    if (sorted_merge_offers.size() >= clustering_params.max_results_size &&
-        current_weighted_dissimilarity >= sorted_merge_offers.front().weighted_dissimilarity)
-        return;
+void HierarchicalClustering::calcRowMergeOffers(const ClusteringParams& clustering_params,
+                                                ClusteringWorkspace& workspace, const int row,
+                                                const bool keep_all_offers) const{
+    vector<ClustersMergeOffer>& row_merge_offers = workspace.row_merge_offers[row];
+    row_merge_offers.clear();
+
+    int num_row_merge_offers = 0;
+    if (workspace.clusters[row]->isActivated()) {
+        // if one of the given cluster is invalid there is no merge offer
+        workspace.forEachActiveCellInRow(row, [&](const int j, const AlgorithmDSManager::DissimilarityCell& cell){
+            const ClustersMergeOffer merge_offer(
+                    getDistanceBetweenClusters(clustering_params, workspace, row, j, cell.jaccard_distance), row, j);
+            num_row_merge_offers++;
+
+            if (keep_all_offers)
+                row_merge_offers.push_back(merge_offer);
+            else
+                updateSortedMergeOffers(row_merge_offers, clustering_params.max_results_size, merge_offer);
+        });
+
+        // a row without candidate pairs holds its offers with the nearest active clusters before it instead (as pairs
+        // without shared blocks), so the clusters which are no candidate of any cluster before them are still merged
+        if (num_row_merge_offers == 0 && workspace.useCandidateCells()) {
+            for (int j = row - 1; j >= 0 && row_merge_offers.size() < clustering_params.max_results_size; --j) {
+                if (workspace.cluster_overlay_row[j] == ClusteringWorkspace::DEACTIVATED_CLUSTER)
+                    continue;
+
+                row_merge_offers.emplace_back(getDistanceBetweenClusters(clustering_params, workspace, row, j,
+                        AlgorithmDSManager::NON_CANDIDATE_CELL.jaccard_distance), row, j);
+                num_row_merge_offers++;
+            }
+        }
+    }
 
-    // in case we are using load balance and the new sizes in case of a merge are invalid
-    if (clustering_params.load_balance && !isValidClustersMerge(clustering_params, cluster1, cluster2))
-        return;
+    sort(row_merge_offers.begin(), row_merge_offers.end(), HierarchicalClustering::sortAsc);
+    workspace.is_row_merge_offers_complete[row] = num_row_merge_offers == row_merge_offers.size();
+}
+
+void HierarchicalClustering::initRowsMergeOffers(const ClusteringParams& clustering_params,
+                                                 ClusteringWorkspace& workspace) const{
+    const int num_leaves = workspace.getNumberOfLeaves();
+    workspace.row_merge_offers.resize(num_leaves);
+    workspace.is_row_merge_offers_complete.resize(num_leaves);
 
-    if (sorted_merge_offers.size() < clustering_params.max_results_size){
-        // we are yet to collect max_results_size values
-        sorted_merge_offers.emplace_back(current_weighted_dissimilarity, cluster1, cluster2);
+    // the rows are scanned in order, every block of rows is fetched along with the next one so the next block is read
+    // while the current one is scanned
+    static constexpr int PREFETCH_ROWS = 64;
+    for (int i = 0; i < num_leaves; ++i) {
+        if (i % PREFETCH_ROWS == 0)
+            workspace.prefetchLeavesRows(i, min(i + 2 * PREFETCH_ROWS, num_leaves));
+
+        calcRowMergeOffers(clustering_params, workspace, i, false);
     }
-    else if (current_weighted_dissimilarity < sorted_merge_offers.front().weighted_dissimilarity){
-        // this value is smaller than our max value, replace
-        sorted_merge_offers.front() = {current_weighted_dissimilarity, cluster1, cluster2};
+}
+
+void HierarchicalClustering::updateRowsMergeOffers(const ClusteringParams& clustering_params,
+                                                   ClusteringWorkspace& workspace,
+                                                   const ClustersMergeOffer& merge_offer) const{
+    const int merged_cluster = merge_offer.cluster1;
+    const int removed_cluster = merge_offer.cluster2;
+    const bool use_candidate_cells = workspace.useCandidateCells();
+
+    // the removed cluster's row is empty from now on and the merged cluster's row is fully changed
+    calcRowMergeOffers(clustering_params, workspace, removed_cluster, false);
+    calcRowMergeOffers(clustering_params, workspace, merged_cluster, false);
+
+    // a row without candidate pairs holds offers with its max_results_size nearest active clusters before it, so the
+    // rows of the active clusters right after the merged clusters which hold an offer with them are calculated again
+    // (before the offers with the removed cluster are erased below, since such a row may still be a candidate of the
+    // merged clusters through their own rows)
+    if (use_candidate_cells) {
+        for (const int cluster : {merged_cluster, removed_cluster}) {
+            int num_visited_rows = 0;
+            for (int i = cluster + 1;
+                 i < workspace.clusters.size() && num_visited_rows < clustering_params.max_results_size; ++i) {
+                if (workspace.cluster_overlay_row[i] == ClusteringWorkspace::DEACTIVATED_CLUSTER)
+                    continue;
+
+                num_visited_rows++;
+                const vector<ClustersMergeOffer>& row_merge_offers = workspace.row_merge_offers[i];
+                if (i != merged_cluster && any_of(row_merge_offers.cbegin(), row_merge_offers.cend(),
+                                                  [merged_cluster, removed_cluster](const ClustersMergeOffer& offer){
+                    return offer.cluster2 == merged_cluster || offer.cluster2 == removed_cluster;
+                }))
+                    calcRowMergeOffers(clustering_params, workspace, i, false);
+            }
+        }
     }
 
-    // sort them in descending order for keeping the max value at front
-    sort(sorted_merge_offers.begin(), sorted_merge_offers.end(), HierarchicalClustering::sortDesc);
+    // any other row holds at most one offer with each of the clusters: its offer with the merged cluster has a new
+    // distance and its offer with the removed cluster is gone. a row which does not hold all of its offers holds the
+    // smallest ones, any part of them which starts at the smallest offer is valid as well (findBestMerge fetches the
+    // rest of the row once the held offers are taken), so the row is calculated again only once it holds nothing.
+    // in case only the candidate cells are kept, only the rows of the clusters' candidate pairs hold offers with them
+    // (beside the rows without candidate pairs, see above), and a row which holds nothing may have no candidate pairs
+    // left, so it is calculated again anyway
+    const auto calc_row_if_empty = [&](const int i){
+        if (workspace.row_merge_offers[i].empty() &&
+            (!workspace.is_row_merge_offers_complete[i] || use_candidate_cells))
+            calcRowMergeOffers(clustering_params, workspace, i, false);
+    };
+
+    const int first_changed_row = min(merged_cluster, removed_cluster) + 1;
+    for (const int i : use_candidate_cells ? workspace.merge_neighbours : workspace.active_clusters) {
+        if (i < first_changed_row || i == merged_cluster)
+            continue;
+
+        vector<ClustersMergeOffer>& row_merge_offers = workspace.row_merge_offers[i];
+        const auto removed_offer_it = find_if(row_merge_offers.begin(), row_merge_offers.end(),
+                                              [removed_cluster](const ClustersMergeOffer& offer){
+            return offer.cluster2 == removed_cluster;
+        });
+        const bool is_removed_offer_in_row = removed_offer_it != row_merge_offers.end();
+        if (is_removed_offer_in_row)
+            row_merge_offers.erase(removed_offer_it);
+
+        if (merged_cluster > i) {
+            // the offer with the merged cluster is in the merged cluster's row
+            calc_row_if_empty(i);
+            continue;
+        }
+
+        const auto merged_offer_it = find_if(row_merge_offers.begin(), row_merge_offers.end(),
+                                             [merged_cluster](const ClustersMergeOffer& offer){
+            return offer.cluster2 == merged_cluster;
+        });
+        const bool is_merged_offer_in_row = merged_offer_it != row_merge_offers.end();
+        if (is_merged_offer_in_row)
+            row_merge_offers.erase(merged_offer_it);
+
+        // the merged cluster may not be a candidate of the row anymore, its offer may be one of the offers of a row
+        // without candidate pairs (calculated above), so such a row is calculated again
+        if (use_candidate_cells && !workspace.findCandidateCell(i, merged_cluster)) {
+            if (is_merged_offer_in_row)
+                calcRowMergeOffers(clustering_params, workspace, i, false);
+            else
+                calc_row_if_empty(i);
+            continue;
+        }
+
+        const ClustersMergeOffer new_merged_offer(getDistanceBetweenClusters(clustering_params, workspace, i, merged_cluster),
+                                                  i, merged_cluster);
+
+        // the offers of a row which does not hold all of its offers may be followed by smaller offers than the new
+        // one, so the new offer is kept only in case it is not greater than all of them
+        if (!workspace.is_row_merge_offers_complete[i] &&
+            (row_merge_offers.empty() || sortAsc(row_merge_offers.back(), new_merged_offer))) {
+            calc_row_if_empty(i);
+            continue;
+        }
+
+        row_merge_offers.insert(upper_bound(row_merge_offers.begin(), row_merge_offers.end(), new_merged_offer,
+                                            HierarchicalClustering::sortAsc), new_merged_offer);
+
+        if (!workspace.is_row_merge_offers_complete[i] && row_merge_offers.size() > clustering_params.max_results_size)
+            row_merge_offers.pop_back();
+    }
 }
 
 bool HierarchicalClustering::sortDesc(const ClustersMergeOffer &a, const ClustersMergeOffer &b) {
@@ -229,25 +636,32 @@ bool HierarchicalClustering::sortAsc(const ClustersMergeOffer &a, const Clusters
 }
 
 double HierarchicalClustering::getPhysicalDistanceOfCluster(const int max_number_of_clusters,
-                                                            const AlgorithmDSManager::DissimilarityCell& diss_cell,
-                                                            const double W_T, const bool use_new_dist_metric){
+                                                            const OriginClustersSizes& size_from_origin_clusters,
+                                                            const double W_T, const bool use_new_dist_metric) const{
     long long summed_files_size = 0;
     long long max_origin_files_size = 0;
-    for(const auto origin_cluster_size_pair : diss_cell.size_from_origin_clusters)
+    for(uint32_t mask = size_from_origin_clusters.getPresentClustersMask(); mask != 0; mask &= mask - 1)
     {
-        summed_files_size += origin_cluster_size_pair.second;
-        if(origin_cluster_size_pair.second > max_origin_files_size){
-            max_origin_files_size = origin_cluster_size_pair.second;
+        const long long origin_cluster_size = size_from_origin_clusters.getSize(__builtin_ctz(mask));
+        summed_files_size += origin_cluster_size;
+        if(origin_cluster_size > max_origin_files_size){
+            max_origin_files_size = origin_cluster_size;
         }
     }
 
     const double num_cluster_fraction =
-            static_cast<double>(diss_cell.size_from_origin_clusters.size()) / max_number_of_clusters;
+            static_cast<double>(size_from_origin_clusters.size()) / max_number_of_clusters;
 
     if(!use_new_dist_metric){
         return num_cluster_fraction;
     }
 
+    // a cell without any sampled size (files without any of the chosen fingerprints) has no physical distance,
+    // dividing by its zero size would make the distance NaN and the merge offers order undefined
+    if(summed_files_size == 0){
+        return 0;
+    }
+
     const double files_size_fraction =
             static_cast<double>(summed_files_size - (static_cast<double>(1-W_T) * max_origin_files_size)) /
             summed_files_size;
@@ -256,21 +670,31 @@ double HierarchicalClustering::getPhysicalDistanceOfCluster(const int max_number
 }
 
 double HierarchicalClustering::getDistanceBetweenClusters(const ClusteringParams& clustering_params,
-                                                          const int cluster1, const int cluster2){
+                                                          const ClusteringWorkspace& workspace,
+                                                          const int cluster1, const int cluster2) const{
+    return getDistanceBetweenClusters(clustering_params, workspace, cluster1, cluster2,
+                                      workspace.getDissimilarityCell(cluster1, cluster2).jaccard_distance);
+}
+
+double HierarchicalClustering::getDistanceBetweenClusters(const ClusteringParams& clustering_params,
+                                                          const ClusteringWorkspace& workspace,
+                                                          const int cluster1, const int cluster2,
+                                                          const double jaccard_distance) const{
     const int max_number_of_clusters = m_ds->getNumOfWorkloads();
     const double W_T = (clustering_params.w_traffic / 100.0);
-    const AlgorithmDSManager::DissimilarityCell& cluster1_2_dissimilarity = m_ds->getDissimilarityCell(cluster1, cluster2);
 
-    const double physical_distance = getPhysicalDistanceOfCluster(max_number_of_clusters,
-                                                                  cluster1_2_dissimilarity,
-                                                                  W_T, clustering_params.use_new_dist_metric);
+    const double physical_distance = getPhysicalDistanceOfCluster(
+            max_number_of_clusters,
+            OriginClustersSizes::getMerged(workspace.size_from_origin_clusters[cluster1],
+                                           workspace.size_from_origin_clusters[cluster2]),
+            W_T, clustering_params.use_new_dist_metric);
 
-    return (1 - W_T) * physical_distance + W_T * cluster1_2_dissimilarity.jaccard_distance;
+    return (1 - W_T) * physical_distance + W_T * jaccard_distance;
 }
 
 HierarchicalClustering::ClustersMergeOffer HierarchicalClustering::randClustersMergeOfferFromVector(
         const vector<ClustersMergeOffer>& sorted_merge_offers,
-        const double gap){
+        const double gap, RandomGenerator& random_generator){
     // get the last index which is in gap range
     int max_index_in_gap = sorted_merge_offers.size() - 1;
     while (max_index_in_gap >= 1 ){
@@ -282,33 +706,39 @@ HierarchicalClustering::ClustersMergeOffer HierarchicalClustering::randClustersM
     }
 
     // fetch random value from the vector
-    const int random_index = rand() % (max_index_in_gap + 1);
+    const int random_index = random_generator.next() % (max_index_in_gap + 1);
 
     return sorted_merge_offers[random_index];
 }
 
-bool HierarchicalClustering::isValidClustersMerge(const ClusteringParams& clustering_params, const int cluster1,
+bool HierarchicalClustering::isValidClustersMerge(const ClusteringParams& clustering_params,
+                                                  const ClusteringWorkspace& workspace, const int cluster1,
                                                   const int cluster2) const{
 
-    // compile a list of all the current clusters' sizes in the system beside those we merge
-    vector<double> curr_sizes;
-    curr_sizes.reserve(m_ds->getNumberOfFilesForClustering());
-
-    for (int i = 0; i < m_ds->getNumberOfFilesForClustering(); ++i) {
-        if (i != cluster1 && i != cluster2 && m_clusters[i]->isActivated())
-            curr_sizes.push_back(m_clusters[i]->getSize());
-    }
-
-    // add the size of the clusters we merge into one
-    curr_sizes.push_back(getMergedClusterSize(cluster1, cluster2));
-
-    // sort in descending order
-    std::sort(curr_sizes.begin(), curr_sizes.end(), std::greater<double>());
+    // only the largest m_lb_sizes.size() sizes are constrained, so walk the active clusters' sizes in descending order
+    // (beside those we merge) and place the size of the clusters we merge into one on the way
+    const double merged_cluster_size = getMergedClusterSize(workspace, cluster1, cluster2);
+    bool is_merged_cluster_size_placed = false;
+    auto active_cluster_it = workspace.active_clusters_sizes.cbegin();
 
-    // assert that our constraints are satisfied
     for (int i = 0; i < m_lb_sizes.size(); ++i) {
-        if (curr_sizes[i] > ((m_lb_sizes[i] + clustering_params.internal_margin)/ 100.0) *
-                            clustering_params.approx_system_size){
+        while (active_cluster_it != workspace.active_clusters_sizes.cend() &&
+               (active_cluster_it->second == cluster1 || active_cluster_it->second == cluster2))
+            ++active_cluster_it;
+
+        double curr_size = 0;
+        if (!is_merged_cluster_size_placed && (active_cluster_it == workspace.active_clusters_sizes.cend() ||
+                                               merged_cluster_size >= active_cluster_it->first)) {
+            curr_size = merged_cluster_size;
+            is_merged_cluster_size_placed = true;
+        } else if (active_cluster_it != workspace.active_clusters_sizes.cend()) {
+            curr_size = active_cluster_it->first;
+            ++active_cluster_it;
+        }
+
+        // assert that our constraints are satisfied
+        if (curr_size > ((m_lb_sizes[i] + clustering_params.internal_margin)/ 100.0) *
+                        clustering_params.approx_system_size){
             return false;
         }
     }
@@ -316,93 +746,199 @@ bool HierarchicalClustering::isValidClustersMerge(const ClusteringParams& cluste
     return true;
 }
 
-int HierarchicalClustering::getClusterSize(const set<int>& files_indices) const{
-    // find the files of the merged cluster
-    unordered_set<int> cluster_blocks;
-    int cluster_size = 0;
-
-    for (int fp_index = 0; fp_index < m_ds->getNumberOfFingerprintsForClustering(); ++fp_index) {
-        for (const auto& file_index : files_indices) {
-            // we will add its size to cluster_size
-            if (m_ds->isFileHasFingerprint(file_index, fp_index) && cluster_blocks.find(fp_index) == cluster_blocks.cend()){
-                cluster_size += m_ds->getFingerprintSize(fp_index);
-                cluster_blocks.insert(fp_index);
-            }
-        }
-    }
+long long HierarchicalClustering::getFileBlocksSize(const int file_index) const{
+    long long file_blocks_size = 0;
+    m_ds->getFileBlocksIndex().forEachBlockInFile(file_index, [this, &file_blocks_size](const int fp_index){
+        file_blocks_size += m_ds->getFingerprintSize(fp_index);
+    });
 
-    return cluster_size;
+    return file_blocks_size;
 }
 
-double HierarchicalClustering::getMergedClusterSize(const int cluster1, const int cluster2) const{
-    // find the files of the merged cluster
-    unordered_set<int> cluster_blocks;
-    int cluster_size = 0;
+double HierarchicalClustering::getMergedClusterSize(const ClusteringWorkspace& workspace, const int cluster1,
+                                                    const int cluster2) const{
+    // the shared blocks are counted in both clusters' sizes
+    const long long shared_blocks_size = workspace.cluster_blocks.getIntersectionWeight(
+            cluster1, cluster2, [this](const int fp_index){
+        return m_ds->getFingerprintSize(fp_index);
+    });
 
-    for (int fp_index = 0; fp_index < m_ds->getNumberOfFingerprintsForClustering(); ++fp_index) {
-        for (const auto& file_index : m_clusters[cluster1]->getCurrentFiles()) {
-
-            if (m_ds->isFileHasFingerprint(file_index, fp_index) && cluster_blocks.find(fp_index) == cluster_blocks.cend()){
-                cluster_size += m_ds->getFingerprintSize(fp_index);
-                cluster_blocks.insert(fp_index);
-            }
-        }
-
-        for (const auto& file_index : m_clusters[cluster2]->getCurrentFiles()) {
-            if (m_ds->isFileHasFingerprint(file_index, fp_index) && cluster_blocks.find(fp_index) == cluster_blocks.cend()){
-                cluster_size += m_ds->getFingerprintSize(fp_index);
-                cluster_blocks.insert(fp_index);
-            }
-        }
-    }
+    return workspace.clusters[cluster1]->getSize() + workspace.clusters[cluster2]->getSize() - shared_blocks_size;
+}
 
-    return cluster_size;
+void HierarchicalClustering::mergeClusters(const ClusteringParams& clustering_params, ClusteringWorkspace& workspace,
+                                           const ClustersMergeOffer& merge_offer) {
+    mergeClustersWithoutMergeOffers(workspace, merge_offer);
+    updateRowsMergeOffers(clustering_params, workspace, merge_offer);
 }
 
-void HierarchicalClustering::mergeClusters(const ClustersMergeOffer& merge_offer,
-                                           const std::unordered_map<int,int>& file_to_cluster) {
-    m_current_system_size -= m_clusters[merge_offer.cluster2]->getSize();
-    m_current_system_size -= m_clusters[merge_offer.cluster1]->getSize();
+void HierarchicalClustering::mergeClustersWithoutMergeOffers(ClusteringWorkspace& workspace,
+                                                             const ClustersMergeOffer& merge_offer) {
+    workspace.merges.emplace_back(merge_offer.cluster1, merge_offer.cluster2);
+    workspace.markClusterModified(merge_offer.cluster1);
+    workspace.markClusterModified(merge_offer.cluster2);
+    workspace.current_system_size -= workspace.clusters[merge_offer.cluster2]->getSize();
+    workspace.current_system_size -= workspace.clusters[merge_offer.cluster1]->getSize();
+    workspace.active_clusters_sizes.erase({workspace.clusters[merge_offer.cluster2]->getSize(), merge_offer.cluster2});
+    workspace.active_clusters_sizes.erase({workspace.clusters[merge_offer.cluster1]->getSize(), merge_offer.cluster1});
 
-    completeLinkage(merge_offer, file_to_cluster);
+    completeLinkage(workspace, merge_offer);
 
     // disable cluster 2 files to cluster 1 since we gonna it as the merged cluster
-    m_clusters[merge_offer.cluster1]->addFiles( m_clusters[merge_offer.cluster2]->getCurrentFiles());
+    workspace.clusters[merge_offer.cluster1]->addFiles( workspace.clusters[merge_offer.cluster2]->getCurrentFiles());
 
     //calculate cluster 1 size after merging cluster 2 to it
-    m_clusters[merge_offer.cluster1]->setSize(getClusterSize(m_clusters[merge_offer.cluster1]->getCurrentFiles()));
+    workspace.clusters[merge_offer.cluster1]->setSize(getMergedClusterSize(workspace, merge_offer.cluster1, merge_offer.cluster2));
+    workspace.cluster_blocks.orRow(merge_offer.cluster1, merge_offer.cluster2);
 
     // disable nodes since we gonna user cluster1
-    m_clusters[merge_offer.cluster2]->disableNode();
+    workspace.clusters[merge_offer.cluster2]->disableNode();
 
-    m_current_system_size += m_clusters[merge_offer.cluster1]->getSize();
+    workspace.current_system_size += workspace.clusters[merge_offer.cluster1]->getSize();
+    workspace.active_clusters_sizes.emplace(workspace.clusters[merge_offer.cluster1]->getSize(), merge_offer.cluster1);
 
     //deactivate merge_offer.cluster2 since we are going to use merge_offer.cluster1 index only
-    m_ds->deactivateClusterInDissimilarityMat(merge_offer.cluster2);
+    workspace.deactivateClusterInDissimilarityMat(merge_offer.cluster2);
 }
 
-void HierarchicalClustering::completeLinkage(const ClustersMergeOffer& merge_offer,
-                                             const std::unordered_map<int,int>& file_to_cluster) {
+void HierarchicalClustering::preMergeClusters(const ClusteringParams& clustering_params, ClusteringWorkspace& workspace,
+                                              int& num_current_clusters) {
+    for (const pair<int, int>& merge : m_warm_start_merges) {
+        if (num_current_clusters <= clustering_params.number_of_clusters)
+            break;
+
+        // the dissimilarity of the merge offer is not used by the merge
+        static constexpr double NOT_RELEVANT = 0;
+        mergeClustersWithoutMergeOffers(workspace, ClustersMergeOffer(NOT_RELEVANT, merge.first, merge.second));
+        num_current_clusters--;
+    }
+}
+
+vector<pair<int, int>> HierarchicalClustering::getWarmStartMerges() const{
+    vector<pair<int, int>> warm_start_merges;
+    // the indices of the super nodes are not kept between versions
+    if (m_warm_start_percent == NO_WARM_START || !m_previous_dendrogram || m_use_super_nodes)
+        return warm_start_merges;
+
+    // a cluster is dirty once it contains a removed file, the merges of dirty clusters are not taken. the previous
+    // clustering's files keep their indices, so its clusters are given by the same indices
+    const int num_merges = static_cast<long long>(m_previous_dendrogram->size()) * m_warm_start_percent / 100;
+    vector<bool> is_cluster_dirty(m_ds->getNumberOfFilesForClustering(), false);
+    for (int i = 0; i < is_cluster_dirty.size(); ++i)
+        is_cluster_dirty[i] = m_ds->isFileRemoved(i);
+
+    for (int i = 0; i < num_merges; ++i) {
+        const pair<int, int>& merge = (*m_previous_dendrogram)[i];
+        if (is_cluster_dirty[merge.first] || is_cluster_dirty[merge.second]) {
+            is_cluster_dirty[merge.first] = true;
+            continue;
+        }
+
+        warm_start_merges.push_back(merge);
+    }
+
+    return warm_start_merges;
+}
+
+void HierarchicalClustering::completeLinkage(ClusteringWorkspace& workspace, const ClustersMergeOffer& merge_offer) {
     // complete linkage before performing the merge_offer (update dissimilarities matrix)
+    if (workspace.useCandidateCells()) {
+        completeCandidateCellsLinkage(workspace, merge_offer);
+    } else {
+        // cluster1's cells are all rewritten, so they are updated in its overlay row in place
+        vector<AlgorithmDSManager::DissimilarityCell>& cluster1_dissimilarities = workspace.getOverlayRow(merge_offer.cluster1);
+
+        // iterate each active cluster, the cells of deactivated clusters are never read again
+        for (const int i : workspace.active_clusters) {
+            const AlgorithmDSManager::DissimilarityCell& cluster2_and_i_dissimilarity = workspace.getDissimilarityCell(merge_offer.cluster2, i);
+
+            if ((cluster2_and_i_dissimilarity.jaccard_distance != DBL_MAX)) {
+                const AlgorithmDSManager::DissimilarityCell new_dissimilarity_cell = {
+                        max(cluster2_and_i_dissimilarity.jaccard_distance, cluster1_dissimilarities[i].jaccard_distance)
+                };
 
-    // iterate each file
-    for (int i = 0; i < m_ds->getNumberOfFilesForClustering(); ++i) {
-        const AlgorithmDSManager::DissimilarityCell cluster2_and_i_dissimilarity = m_ds->getDissimilarityCell(merge_offer.cluster2, i);
+                // set the new value ( we only set cluster1 and i since cluster2 will be soon deactivated)
+                cluster1_dissimilarities[i] = new_dissimilarity_cell;
+                if (workspace.cluster_overlay_row[i] >= 0)
+                    workspace.overlay_rows[workspace.cluster_overlay_row[i]][merge_offer.cluster1] = new_dissimilarity_cell;
+            }
+        }
+    }
 
-        if ((cluster2_and_i_dissimilarity.jaccard_distance != DBL_MAX)) {
-            const AlgorithmDSManager::DissimilarityCell cluster1_and_i_dissimilarity = m_ds->getDissimilarityCell(merge_offer.cluster1, i);
+    // cluster1 holds the files of both clusters from now on
+    workspace.size_from_origin_clusters[merge_offer.cluster1] = OriginClustersSizes::getMerged(
+            workspace.size_from_origin_clusters[merge_offer.cluster1],
+            workspace.size_from_origin_clusters[merge_offer.cluster2]);
+}
 
-            const AlgorithmDSManager::DissimilarityCell new_dissimilarity_cell = {
-                    max(cluster2_and_i_dissimilarity.jaccard_distance, cluster1_and_i_dissimilarity.jaccard_distance),
-                    Utility::getMergedMap(cluster2_and_i_dissimilarity.size_from_origin_clusters,
-                                          cluster1_and_i_dissimilarity.size_from_origin_clusters,
-                                          m_ds->getDissimilarityCell(i, i).size_from_origin_clusters)
-            };
+void HierarchicalClustering::completeCandidateCellsLinkage(ClusteringWorkspace& workspace,
+                                                           const ClustersMergeOffer& merge_offer){
+    const int cluster1 = merge_offer.cluster1;
+    const int cluster2 = merge_offer.cluster2;
+
+    ClusteringWorkspace::CandidateCells cluster2_cells;
+    const auto add_cluster2_cell = [&cluster2_cells](const int j, const AlgorithmDSManager::DissimilarityCell& cell){
+        cluster2_cells.emplace_back(j, cell);
+    };
+    workspace.forEachActiveCandidateCell(cluster2, workspace.cluster_overlay_row.size(), add_cluster2_cell);
+
+    // cluster1's cells are all rewritten, so they are updated in its overlay row in place. both rows are ordered, so
+    // a single pass over them finds the clusters which are candidates of both (the new cell is the max of the two)
+    ClusteringWorkspace::CandidateCells& cluster1_cells = workspace.getCandidateOverlayRow(cluster1);
+    workspace.merge_neighbours.clear();
+    int num_cluster1_cells = 0;
+    auto cluster2_cell_it = cluster2_cells.cbegin();
+    for (const auto& cluster1_cell : cluster1_cells) {
+        for (; cluster2_cell_it != cluster2_cells.cend() && cluster2_cell_it->first < cluster1_cell.first; ++cluster2_cell_it)
+            workspace.merge_neighbours.push_back(cluster2_cell_it->first);
+
+        if (cluster1_cell.first == cluster2)
+            continue;
 
-            // set the new value ( we only set cluster1 and i since cluster2 will be soon deactivated)
-            m_ds->setDissimilarityCell(merge_offer.cluster1, i, new_dissimilarity_cell);
+        workspace.merge_neighbours.push_back(cluster1_cell.first);
+        if (cluster2_cell_it != cluster2_cells.cend() && cluster2_cell_it->first == cluster1_cell.first) {
+            cluster1_cells[num_cluster1_cells++] = {cluster1_cell.first, {max(cluster1_cell.second.jaccard_distance,
+                                                                              cluster2_cell_it->second.jaccard_distance)}};
+            ++cluster2_cell_it;
         }
     }
+    for (; cluster2_cell_it != cluster2_cells.cend(); ++cluster2_cell_it)
+        workspace.merge_neighbours.push_back(cluster2_cell_it->first);
+    cluster1_cells.resize(num_cluster1_cells);
+
+    // cluster1 was a candidate of cluster2, it is not a neighbour of its own
+    workspace.merge_neighbours.erase(remove(workspace.merge_neighbours.begin(), workspace.merge_neighbours.end(), cluster1),
+                                     workspace.merge_neighbours.end());
+
+    // the overlay rows are kept symmetric: the neighbours' overlay rows lose cluster2 (which is soon deactivated) and
+    // hold cluster1 only in case it is still a candidate of them
+    for (const int i : workspace.merge_neighbours) {
+        if (workspace.cluster_overlay_row[i] < 0)
+            continue;
+
+        ClusteringWorkspace::CandidateCells& i_cells = workspace.candidate_overlay_rows[workspace.cluster_overlay_row[i]];
+        const AlgorithmDSManager::DissimilarityCell* const merged_cell =
+                ClusteringWorkspace::findCandidateCell(cluster1_cells, i);
+        const auto find_i_cell = [&i_cells](const int cluster_index){
+            return lower_bound(i_cells.begin(), i_cells.end(), cluster_index,
+                               [](const pair<int, AlgorithmDSManager::DissimilarityCell>& cell, const int cell_cluster){
+                return cell.first < cell_cluster;
+            });
+        };
+
+        const auto cluster2_cell_it = find_i_cell(cluster2);
+        if (cluster2_cell_it != i_cells.end() && cluster2_cell_it->first == cluster2)
+            i_cells.erase(cluster2_cell_it);
+
+        const auto cluster1_cell_it = find_i_cell(cluster1);
+        if (cluster1_cell_it == i_cells.end() || cluster1_cell_it->first != cluster1)
+            continue;
+
+        if (merged_cell)
+            cluster1_cell_it->second = *merged_cell;
+        else
+            i_cells.erase(cluster1_cell_it);
+    }
 }
 
 string HierarchicalClustering::getResultFileName(const bool contain_changes, const int num_total_iter, const int num_change_iter,
@@ -448,10 +984,10 @@ shared_ptr<Calculator::CostResult> HierarchicalClustering::applyChangesToMapping
         }
     }
     const map<string, double> arranged_lb_sized = m_ds->getArrangedLbSizes(m_lb_sizes);
-    const map<int, int> &block_to_size_mapping = m_ds->getBlockToSizeMap();
+    const vector<int> &block_to_size_mapping = m_ds->getBlockToSize();
 
     return Calculator::getClusteringCost(is_iter_contains_changes,
-            use_cache, m_ds->getAppearancesMatrix(), block_to_size_mapping,
+            use_cache, m_ds->getFileBlocksIndex(), block_to_size_mapping,
             *init_mapping,
             *final_mapping,
             added_files,
@@ -622,8 +1158,11 @@ void HierarchicalClustering::runWithNaiveSplit(const vector<string>& workload_pa
                 CALC_NO_CHANGES, iter_specific_results, total_current_iter,
                 total_current_change_iter, load_balance, use_cache, immediate_cache, allowed_traffic_in_bytes,
                 VALIDATE, margin, immediate_output);
+        validateSweepBudget(iter_specific_results);
         sort(iter_specific_results.begin(), iter_specific_results.end(), ClusteringResult::sortResultDesc);
         shared_ptr<HierarchicalClustering::ClusteringResult> best_iter_res = iter_specific_results.front();
+        if (best_iter_res->dendrogram)
+            m_previous_dendrogram = best_iter_res->dendrogram;
 
         transfers =
                 GreedySplit::getTransfers(workload_path_to_index, workload_paths,
@@ -664,8 +1203,8 @@ void HierarchicalClustering::runWithNaiveSplit(const vector<string>& workload_pa
 
                 std::cout << "left "<< transfers.size() <<" transfers out" << std::endl;
                 iter_cost = Calculator::getClusteringCost(
-                        false, use_cache, m_ds->getAppearancesMatrix(),
-                        m_ds->getBlockToSizeMap(),
+                        false, use_cache, m_ds->getFileBlocksIndex(),
+                        m_ds->getBlockToSize(),
                         m_ds->getInitialClustering(),
                         *final_mapping,
                         {},
@@ -813,10 +1352,15 @@ void HierarchicalClustering::run(const vector<string>& workload_paths, const std
                     CALC_NO_CHANGES, iter_specific_results, total_current_iter,
                     total_current_change_iter, load_balance, use_cache, cache_path, hc_allowed_traffic_for_iter,
                     VALIDATE, initial_internal_margin, output_path_prefix);
+            validateSweepBudget(iter_specific_results);
 
             sort(iter_specific_results.begin(), iter_specific_results.end(), ClusteringResult::sortResultDesc);
             shared_ptr<HierarchicalClustering::ClusteringResult> best_iter_res = iter_specific_results.front();
 
+            // the next clustering warm starts from the chosen clustering (unless nothing was chosen)
+            if (best_iter_res->dendrogram)
+                m_previous_dendrogram = best_iter_res->dendrogram;
+
             if(change_pos == "smart_split"){
                 vector<std::shared_ptr<transfer_t>> transfers =
                             GreedySplit::getTransfers(workload_path_to_index, workload_paths,
@@ -832,8 +1376,8 @@ void HierarchicalClustering::run(const vector<string>& workload_paths, const std
 
                 std::cout << "left "<< transfers.size() <<" transfers out" << std::endl;
                 best_iter_res->cost_result = Calculator::getClusteringCost(
-                        false, use_cache, m_ds->getAppearancesMatrix(),
-                        m_ds->getBlockToSizeMap(),
+                        false, use_cache, m_ds->getFileBlocksIndex(),
+                        m_ds->getBlockToSize(),
                         *best_iter_res->clustering_initial_mapping,
                         *best_iter_res->clustering_final_mapping,
                         {},
@@ -940,44 +1484,180 @@ vector<shared_ptr<HierarchicalClustering::ClusteringResult>> HierarchicalCluster
     map<double, long long int > timer_per_wt = {};
     static constexpr int MAX_RESULTS_SIZE = 10;
 
-    // for each combo of seed, gap, wt execute the algorithm
-    for(const double wt: wts){
-        const auto wt_run_start_time = chrono::high_resolution_clock::now();
-        for (const int seed : seeds){
-            srand(seed);
-            for (const double gap :gaps){
-                // create our results csv
-
-                ClusteringParams clustering_params(wt, total_traffic_max, iter_traffic_bytes, iter_traffic,seed, gap,
-                                                   m_ds->getInitialSystemSize(),
-                                                   m_ds->getOptimalSystemSize(), load_balance,
-                                                   m_ds->getNumOfWorkloads(), MAX_RESULTS_SIZE,
-                                                   eps, margin_iter, num_iter, m_ds->getCurrentHostName(),
-                                                   num_iterations, current_change_iter, current_total_iter,
-                                                   use_new_dist_metric);
-
-                // loop until we succeed to build a valid dendrogram
-                while(!performClustering(clustering_params)){
+    // every (wt, seed) combo is a single work item which runs all the gaps one after another, since all the gaps of a
+    // seed share the same random sequence. the results are kept in the order of the serial wt -> seed -> gap loops
+    const int num_work_items = wts.size() * seeds.size();
+    vector<shared_ptr<ClusteringResult>> sweep_results(num_work_items * gaps.size());
+    vector<chrono::high_resolution_clock::duration> work_item_elapsed_time(num_work_items);
+    mutex output_lock;
+    const auto sweep_start_time = chrono::high_resolution_clock::now();
+    int num_different_merges = 0;
+    int num_different_clusterings = 0;
+    double max_system_size_deviation = 0;
+    m_warm_start_merges = getWarmStartMerges();
+
+    // the super nodes are built again whenever the files or the initial mapping change. the clustering merges them down
+    // to a cluster per workload, so there are at least that many of them
+    if (m_use_super_nodes && (!m_super_nodes || m_super_nodes->getDSVersion() != m_ds->getVersion()))
+        m_super_nodes = make_unique<SuperNodes>(*m_ds, m_super_nodes_jaccard_threshold, m_ds->getNumOfWorkloads(),
+                                                m_num_threads);
+
+    // with a sweep budget the clusterings are kept with their estimated costs and final clusters, and only the ones
+    // within the budget are arranged once the sweep is done
+    const bool use_sweep_budget = m_sweep_budget_percent < FULL_SWEEP_BUDGET;
+    const BitMatrix initial_clusters_blocks = use_sweep_budget ? getInitialClustersBlocks(init_cluster_vector) :
+                                                                 BitMatrix();
+    vector<vector<set<int>>> sweep_final_clusters(use_sweep_budget ? sweep_results.size() : 0);
+
+    runSweepWorkItems(num_work_items, [&](const int work_item, ClusteringWorkspace& workspace){
+        const double wt = wts[work_item / seeds.size()];
+        const int seed = seeds[work_item % seeds.size()];
+        const auto work_item_start_time = chrono::high_resolution_clock::now();
+
+        workspace.random_generator.seed(seed);
+        for (int gap_index = 0; gap_index < gaps.size(); ++gap_index){
+            const double gap = gaps[gap_index];
+            ClusteringParams clustering_params(wt, total_traffic_max, iter_traffic_bytes, iter_traffic,seed, gap,
+                                               m_ds->getInitialSystemSize(),
+                                               m_ds->getOptimalSystemSize(), load_balance,
+                                               m_ds->getNumOfWorkloads(), MAX_RESULTS_SIZE,
+                                               eps, margin_iter, num_iter, m_ds->getCurrentHostName(),
+                                               num_iterations, current_change_iter, current_total_iter,
+                                               use_new_dist_metric);
+
+            // the validation runs the clustering again from its first attempt
+            const ClusteringParams first_attempt_clustering_params = clustering_params;
+            const RandomGenerator first_attempt_random_generator = workspace.random_generator;
+
+            const auto fail_attempt = [&](){
+                {
+                    lock_guard<mutex> guard(output_lock);
                     std::cout<< "Failed in iter Num:"<< clustering_params.num_attempts << std::endl;
+                }
 
-                    clustering_params.internal_margin=margin_iter *
-                                                      pow(1 + clustering_params.eps / 100.0, clustering_params.num_attempts);
+                setNextAttemptMargin(clustering_params, margin_iter);
+            };
 
-                    clustering_params.num_attempts++;
+            // loop until we succeed to build a valid dendrogram. a retry starts from singletons with the random
+            // generator continuing, or resumes from the previous one's checkpoint with m_resume_failed_clusterings.
+            // with speculative margins the next margins are tried together, and the failures of the margins below the
+            // smallest successful one are handled as if they were tried one after another
+            const ClusteringWorkspace* result_workspace = &workspace;
+            bool is_clustering_successful = performClustering(clustering_params, workspace, false);
+            while (!is_clustering_successful) {
+                fail_attempt();
+                if (m_num_speculative_margins == 1) {
+                    is_clustering_successful = performClustering(clustering_params, workspace,
+                                                                 m_resume_failed_clusterings);
+                    continue;
                 }
 
-                const shared_ptr<map<string, set<int>>> clustering_result = getClusteringResult(init_cluster_vector);
+                // in case all the margins failed, the last one's failure is handled at the beginning of the loop
+                const int successful_margin_index = performSpeculativeClustering(clustering_params, margin_iter,
+                                                                                 workspace);
+                const int num_failed_margins = successful_margin_index == -1 ? m_num_speculative_margins - 1 :
+                                                                              successful_margin_index;
+                for (int i = 0; i < num_failed_margins; ++i)
+                    fail_attempt();
+
+                if (successful_margin_index == -1)
+                    continue;
+
+                // the next gaps continue the successful margin's random sequence
+                result_workspace = workspace.speculative_workspaces[successful_margin_index].get();
+                workspace.random_generator = result_workspace->random_generator;
+                is_clustering_successful = true;
+            }
+
+            const int result_index = work_item * gaps.size() + gap_index;
+            vector<set<int>> final_clusters = getFinalClusters(*result_workspace);
+            if (use_sweep_budget) {
+                sweep_results[result_index] = make_shared<ClusteringResult>(
+                        clustering_params, init_cluster_map, nullptr,
+                        getEstimatedClusteringCost(*result_workspace, initial_clusters_blocks, iter_traffic_bytes,
+                                                   margin_iter, load_balance));
+                sweep_final_clusters[result_index] = std::move(final_clusters);
+            } else {
+                sweep_results[result_index] = make_shared<ClusteringResult>(
+                        clustering_params, init_cluster_map, getClusteringResult(init_cluster_vector, final_clusters),
+                        nullptr);
+            }
 
+            {
+                lock_guard<mutex> guard(output_lock);
                 std::cout << "Finish for param Wt=" << wt << ",seed=" << seed << ",gap=" <<gap<< " Took  from start = " <<
-                    chrono::duration_cast<chrono::seconds>(chrono::high_resolution_clock::now() - wt_run_start_time).count()<<std::endl;
-                iter_specific_results.emplace_back(make_unique<ClusteringResult>(clustering_params, init_cluster_map, clustering_result,
-                                                                                 nullptr));
+                    chrono::duration_cast<chrono::seconds>(chrono::high_resolution_clock::now() - sweep_start_time).count()<<std::endl;
+            }
+
+            sweep_results[result_index]->dendrogram = make_shared<const vector<pair<int, int>>>(result_workspace->merges);
+
+            if (m_validate_dissimilarities_precision) {
+                const PrecisionValidation validation = validateDissimilaritiesPrecision(
+                        first_attempt_clustering_params, margin_iter, first_attempt_random_generator, workspace,
+                        *result_workspace);
+                const bool is_same_merges = validation.first_different_merge == PrecisionValidation::NO_DIFFERENT_MERGE;
+                const double system_size_deviation = validation.exact_system_size == 0 ? 0 :
+                        100 * abs(validation.system_size - validation.exact_system_size) / validation.exact_system_size;
+
+                lock_guard<mutex> guard(output_lock);
+                num_different_merges += is_same_merges ? 0 : 1;
+                num_different_clusterings += validation.is_same_clustering ? 0 : 1;
+                max_system_size_deviation = max(max_system_size_deviation, system_size_deviation);
+                std::cout << "Validated dissimilarities precision for Wt=" << wt << ",seed=" << seed << ",gap=" << gap
+                          << ": merges=" << (is_same_merges ? string("same") :
+                                             "differ from merge " + to_string(validation.first_different_merge + 1))
+                          << " (" << validation.num_merges << ", exact " << validation.num_exact_merges << ")"
+                          << ", clustering=" << (validation.is_same_clustering ? "same" : "different")
+                          << ", system size=" << validation.system_size << " (exact " << validation.exact_system_size
+                          << ", deviation=" << system_size_deviation << "%)" << std::endl;
             }
         }
 
-        timer_per_wt[wt]= chrono::duration_cast<chrono::seconds>(chrono::high_resolution_clock::now() - wt_run_start_time).count();
+        work_item_elapsed_time[work_item] = chrono::high_resolution_clock::now() - work_item_start_time;
+    });
+
+    if (m_validate_dissimilarities_precision)
+        std::cout << "Dissimilarities precision validation: " << num_different_merges << " of " << sweep_results.size()
+                  << " clusterings chose other merges than the exact clusterings, " << num_different_clusterings
+                  << " chose other clusters, max system size deviation=" << max_system_size_deviation << "%"
+                  << std::endl;
+
+    // the elapsed time of a wt is the summed time of its work items, as if they ran one after another
+    for (int wt_index = 0; wt_index < wts.size(); ++wt_index){
+        chrono::high_resolution_clock::duration wt_elapsed_time(0);
+        for (int seed_index = 0; seed_index < seeds.size(); ++seed_index)
+            wt_elapsed_time += work_item_elapsed_time[wt_index * seeds.size() + seed_index];
+
+        timer_per_wt[wts[wt_index]] = chrono::duration_cast<chrono::seconds>(wt_elapsed_time).count();
+    }
+
+    // only the clusterings with the best estimated costs are evaluated, they are kept in the order of the sweep
+    vector<shared_ptr<ClusteringResult>> estimated_sweep_results;
+    vector<int> estimated_ranking;
+    if (use_sweep_budget) {
+        estimated_ranking.resize(sweep_results.size());
+        iota(estimated_ranking.begin(), estimated_ranking.end(), 0);
+        stable_sort(estimated_ranking.begin(), estimated_ranking.end(), [&sweep_results](const int i, const int j){
+            return ClusteringResult::sortResultDesc(sweep_results[i], sweep_results[j]);
+        });
+
+        const int num_evaluated_clusterings = getNumOfClusteringsInSweepBudget(sweep_results.size());
+        vector<int> evaluated_indices(estimated_ranking.cbegin(), estimated_ranking.cbegin() + num_evaluated_clusterings);
+        sort(evaluated_indices.begin(), evaluated_indices.end());
+
+        estimated_sweep_results = std::move(sweep_results);
+        sweep_results.assign(num_evaluated_clusterings, nullptr);
+        Utility::runInParallel(num_evaluated_clusterings, m_num_threads, [&](const int i, const int){
+            sweep_results[i] = getArrangedSweepResult(*estimated_sweep_results[evaluated_indices[i]],
+                                                      init_cluster_vector, sweep_final_clusters[evaluated_indices[i]]);
+        });
+
+        std::cout << "Sweep budget: evaluating " << num_evaluated_clusterings << " of "
+                  << estimated_sweep_results.size() << " clusterings by their estimated costs" << std::endl;
     }
 
+    iter_specific_results.insert(iter_specific_results.end(), sweep_results.cbegin(), sweep_results.cend());
+
     // Add for each result the w_t elapsed time that relevant for it
     for(auto& iter_specific_result: iter_specific_results){
         iter_specific_result->clustering_params.wt_elapsed_time_seconds = timer_per_wt[iter_specific_result->clustering_params.w_traffic];
@@ -998,13 +1678,215 @@ vector<shared_ptr<HierarchicalClustering::ClusteringResult>> HierarchicalCluster
     iter_specific_results.emplace_back(make_unique<ClusteringResult>(nothing_clustering_params, init_cluster_map,
                                                                      init_cluster_map, nullptr));
 
+    // the dropped clusterings are compared with the evaluated ones once the caller costs them (validateSweepBudget)
+    if (use_sweep_budget && m_validate_sweep_budget)
+        m_sweep_budget_validation = getSweepBudgetValidation(
+                estimated_sweep_results, estimated_ranking, getNumOfClusteringsInSweepBudget(estimated_ranking.size()),
+                sweep_final_clusters, init_cluster_vector, current_change_iter, load_balance, use_cache, cache_path,
+                iter_traffic_bytes, margin_iter);
+
     return std::move(iter_specific_results);
 }
 
 
-shared_ptr<map<string, set<int>>> HierarchicalClustering::getClusteringResult(const vector<set<int>>& initial_clusters) const {
-    const vector<set<int>> final_clusters = getCurrentClustering();
+int HierarchicalClustering::getNumOfClusteringsInSweepBudget(const int num_clusterings) const {
+    // rounded up, so every budget evaluates at least a single clustering
+    const int num_clusterings_in_budget = (num_clusterings * m_sweep_budget_percent + FULL_SWEEP_BUDGET - 1) /
+                                          FULL_SWEEP_BUDGET;
+    return min(num_clusterings, max(num_clusterings_in_budget, 1));
+}
+
+BitMatrix HierarchicalClustering::getInitialClustersBlocks(const vector<set<int>>& initial_clusters) const {
+    const BitMatrix& appearances_matrix = m_ds->getAppearancesMatrix();
+    BitMatrix initial_clusters_blocks(initial_clusters.size(), appearances_matrix.getNumColumns());
+    for (int i = 0; i < initial_clusters.size(); ++i) {
+        for (const int file_index : initial_clusters[i])
+            initial_clusters_blocks.orRow(i, appearances_matrix, file_index);
+    }
+
+    return initial_clusters_blocks;
+}
+
+shared_ptr<Calculator::CostResult> HierarchicalClustering::getEstimatedClusteringCost(
+        const ClusteringWorkspace& workspace, const BitMatrix& initial_clusters_blocks,
+        const long long int allowed_traffic_bytes, const double margin, const bool load_balance) const {
+    const auto fingerprint_size = [this](const int fp_index){
+        return m_ds->getFingerprintSize(fp_index);
+    };
+
+    // the final clusters are in the order of getCurrentClustering, and the workloads are mapped to them by the num of
+    // shared fingerprints like getGreedyWorkloadToClusterMapping maps them by the num of shared blocks
+    vector<int> final_clusters = workspace.active_clusters;
+    sort(final_clusters.begin(), final_clusters.end());
+
+    const int num_workloads = initial_clusters_blocks.getNumRows();
+    vector<vector<int>> intersections(num_workloads, vector<int>(final_clusters.size(), 0));
+    for (int i = 0; i < num_workloads; ++i) {
+        for (int j = 0; j < final_clusters.size(); ++j)
+            intersections[i][j] = initial_clusters_blocks.getIntersectionWeight(i, workspace.cluster_blocks,
+                                                                               final_clusters[j],
+                                                                               [](const int){return 1;});
+    }
+
+    const vector<int> workload_to_cluster_map = getGreedyMapping(std::move(intersections));
+
+    long long initial_size = 0, received_size = 0, deleted_size = 0, final_size = 0;
+    vector<long long> final_volumes_sizes(num_workloads);
+    for (int i = 0; i < num_workloads; ++i) {
+        const int cluster = final_clusters[workload_to_cluster_map[i]];
+        const long long initial_volume_size = initial_clusters_blocks.getIntersectionWeight(i, i, fingerprint_size);
+        const long long shared_size = initial_clusters_blocks.getIntersectionWeight(i, workspace.cluster_blocks, cluster,
+                                                                                    fingerprint_size);
+        final_volumes_sizes[i] = workspace.cluster_blocks.getIntersectionWeight(cluster, cluster, fingerprint_size);
+
+        initial_size += initial_volume_size;
+        received_size += final_volumes_sizes[i] - shared_size;
+        deleted_size += initial_volume_size - shared_size;
+        final_size += final_volumes_sizes[i];
+    }
+
+    // the volumes are load balanced and scored like Calculator does with their final sizes
+    bool is_lb_valid = true;
+    double min_normalized_volume_size = DBL_MAX;
+    double max_normalized_volume_size = 0;
+    for (int i = 0; i < num_workloads; ++i) {
+        const double volume_percentage = final_size == 0 ? 0 : 100.0 * final_volumes_sizes[i] / final_size;
+        if (load_balance && abs(volume_percentage - m_lb_sizes[i]) > margin)
+            is_lb_valid = false;
+
+        const double normalized_volume_size = m_lb_sizes.empty() ? final_volumes_sizes[i] :
+                (100.0 / num_workloads) / m_lb_sizes[i] * final_volumes_sizes[i];
+        min_normalized_volume_size = min(min_normalized_volume_size, normalized_volume_size);
+        max_normalized_volume_size = max(max_normalized_volume_size, normalized_volume_size);
+    }
+
+    const double lb_score = max_normalized_volume_size == 0 ? 1 :
+                            min_normalized_volume_size / max_normalized_volume_size;
+
+    // the sizes of the appearances matrix's fingerprints stand for the sizes of all the blocks
+    const long long int system_size = m_ds->getInitialSystemSize();
+    const double scale = initial_size == 0 ? 0 : static_cast<double>(system_size) / initial_size;
+    const long long int received_bytes = llround(received_size * scale);
+    const long long int deleted_bytes = llround(deleted_size * scale);
+    return make_shared<Calculator::CostResult>(vector<shared_ptr<VolumeCalcInfo>>(),
+                                               received_bytes <= allowed_traffic_bytes, is_lb_valid, "", system_size,
+                                               received_bytes, deleted_bytes, lb_score, received_bytes, 0, 0, 0);
+}
+
+shared_ptr<HierarchicalClustering::ClusteringResult> HierarchicalClustering::getArrangedSweepResult(
+        const ClusteringResult& estimated_result, const vector<set<int>>& initial_clusters,
+        const vector<set<int>>& final_clusters) const {
+    const shared_ptr<ClusteringResult> arranged_result = make_shared<ClusteringResult>(
+            estimated_result.clustering_params, estimated_result.clustering_initial_mapping,
+            getClusteringResult(initial_clusters, final_clusters), nullptr);
+    arranged_result->dendrogram = estimated_result.dendrogram;
+    return arranged_result;
+}
+
+unique_ptr<HierarchicalClustering::SweepBudgetValidation> HierarchicalClustering::getSweepBudgetValidation(
+        const vector<shared_ptr<ClusteringResult>>& estimated_results, const vector<int>& estimated_ranking,
+        const int num_evaluated_clusterings, const vector<vector<set<int>>>& final_clusters,
+        const vector<set<int>>& initial_clusters, const int current_change_iter, const bool load_balance,
+        const bool use_cache, const string& cache_path, const long long int allowed_traffic_bytes,
+        const double margin) {
+    static const bool VALIDATE = false;
+    unique_ptr<SweepBudgetValidation> validation = make_unique<SweepBudgetValidation>();
+    validation->num_clusterings = estimated_ranking.size();
+
+    // the evaluated clusterings are in the order of the sweep
+    vector<int> evaluated_indices(estimated_ranking.cbegin(), estimated_ranking.cbegin() + num_evaluated_clusterings);
+    sort(evaluated_indices.begin(), evaluated_indices.end());
+
+    vector<int> estimated_rank(estimated_ranking.size());
+    for (int rank = 0; rank < estimated_ranking.size(); ++rank)
+        estimated_rank[estimated_ranking[rank]] = rank;
+
+    for (const int index : evaluated_indices)
+        validation->evaluated_estimated_ranks.push_back(estimated_rank[index]);
+
+    // only the dropped clusterings are costed here, the evaluated ones are costed once as the sweep's results
+    for (int rank = num_evaluated_clusterings; rank < estimated_ranking.size(); ++rank) {
+        const int index = estimated_ranking[rank];
+        shared_ptr<ClusteringResult> dropped_result = getArrangedSweepResult(*estimated_results[index],
+                                                                             initial_clusters, final_clusters[index]);
+        dropped_result->cost_result = applyChangesToMappingAndGetCost(
+                false, current_change_iter, load_balance, use_cache, cache_path, allowed_traffic_bytes, VALIDATE,
+                margin, dropped_result->clustering_initial_mapping, dropped_result->clustering_final_mapping);
+        validation->dropped_results.push_back(std::move(dropped_result));
+    }
+
+    return validation;
+}
+
+void HierarchicalClustering::validateSweepBudget(const vector<shared_ptr<ClusteringResult>>& evaluated_results) {
+    if (!m_sweep_budget_validation)
+        return;
+
+    const unique_ptr<SweepBudgetValidation> validation = std::move(m_sweep_budget_validation);
+    static constexpr int NO_ESTIMATED_RANK = -1;
+    const int num_evaluated_clusterings = validation->evaluated_estimated_ranks.size();
+
+    // the results of the full sweep are the evaluated results (with the "do nothing" result, which has no estimated
+    // rank) followed by the dropped results
+    const auto get_result = [&](const int result) -> const shared_ptr<ClusteringResult>& {
+        return result < evaluated_results.size() ? evaluated_results[result] :
+                                                   validation->dropped_results[result - evaluated_results.size()];
+    };
+
+    const auto get_estimated_rank = [&](const int result){
+        if (result < num_evaluated_clusterings)
+            return validation->evaluated_estimated_ranks[result];
+
+        return result < evaluated_results.size() ? NO_ESTIMATED_RANK :
+                                                   num_evaluated_clusterings + result - int(evaluated_results.size());
+    };
+
+    // the best result of the full sweep and the best evaluated result, in the order the results are chosen by
+    vector<int> full_sweep_order(evaluated_results.size() + validation->dropped_results.size());
+    iota(full_sweep_order.begin(), full_sweep_order.end(), 0);
+    stable_sort(full_sweep_order.begin(), full_sweep_order.end(), [&get_result](const int i, const int j){
+        return ClusteringResult::sortResultDesc(get_result(i), get_result(j));
+    });
+
+    const int best_result = full_sweep_order.front();
+    const int best_evaluated_result = *find_if(full_sweep_order.cbegin(), full_sweep_order.cend(),
+                                               [&evaluated_results](const int i){
+        return i < evaluated_results.size();
+    });
+
+    const bool is_best_result_evaluated = best_result == best_evaluated_result;
+    m_num_validated_sweeps++;
+    m_num_surviving_best_results += is_best_result_evaluated ? 1 : 0;
+
+    const auto get_description = [&](const int result){
+        const ClusteringParams& params = get_result(result)->clustering_params;
+        const shared_ptr<Calculator::CostResult>& cost = get_result(result)->cost_result;
+        const int rank = get_estimated_rank(result);
+        return (rank == NO_ESTIMATED_RANK ? string("do nothing") :
+                "Wt=" + Utility::getString(params.w_traffic) + ",seed=" + to_string(params.seed) + ",gap=" +
+                Utility::getString(params.gap) + ", estimated rank " + to_string(rank + 1) + " of " +
+                to_string(validation->num_clusterings)) +
+               ", deletion=" + Utility::getString(cost->deletion_percentage) + "%, traffic=" +
+               Utility::getString(cost->traffic_percentage) + "%";
+    };
+
+    std::cout << "Validated sweep budget: best result of the full sweep (" << get_description(best_result) << ") "
+              << (is_best_result_evaluated ? "was evaluated" :
+                  "was dropped, best evaluated result (" + get_description(best_evaluated_result) + ")")
+              << ". the best result was evaluated in " << m_num_surviving_best_results << " of "
+              << m_num_validated_sweeps << " sweeps" << std::endl;
+}
 
+vector<set<int>> HierarchicalClustering::getFinalClusters(const ClusteringWorkspace& workspace) const {
+    vector<set<int>> final_clusters = getCurrentClustering(workspace);
+    if (m_super_nodes && m_refine_super_nodes)
+        final_clusters = getRefinedClusters(final_clusters);
+
+    return final_clusters;
+}
+
+shared_ptr<map<string, set<int>>> HierarchicalClustering::getClusteringResult(const vector<set<int>>& initial_clusters,
+                                                                            const vector<set<int>>& final_clusters) const {
     const vector<int> workload_to_cluster_map = getGreedyWorkloadToClusterMapping(initial_clusters, final_clusters);
 
     return getArrangedResult(final_clusters, workload_to_cluster_map);
@@ -1039,19 +1921,27 @@ vector<int> HierarchicalClustering::getGreedyWorkloadToClusterMapping(const vect
     const vector<set<int>> initial_clusters_blocks = getBlocksInClusters(initial_clusters);
     const vector<set<int>> final_clusters_blocks = getBlocksInClusters(final_clusters);
 
-    vector<vector<int>> intersections = getBlocksIntersectionOfClusters(initial_clusters_blocks, final_clusters_blocks);
+    return getGreedyMapping(getBlocksIntersectionOfClusters(initial_clusters_blocks, final_clusters_blocks));
+}
+
+vector<int> HierarchicalClustering::getGreedyMapping(vector<vector<int>> intersections) {
+    const int num_initial_clusters = intersections.size();
+    const int num_final_clusters = intersections.empty() ? 0 : intersections.front().size();
 
     // index i is the i'th original workload
-    vector<int> workload_to_cluster_map(initial_clusters_blocks.size(), 0);
+    vector<int> workload_to_cluster_map(num_initial_clusters, 0);
 
     // pair the volumes and clusters based on that matrix in a greedy manner
-    for (int i = 0; i < initial_clusters_blocks.size(); ++i) {
+    for (int i = 0; i < num_initial_clusters; ++i) {
         const pair<int, int> max_indices = findMax(intersections);
+        if (max_indices.first == NO_MAX_INDEX)
+            throw logic_error("there are fewer final clusters (" + to_string(num_final_clusters) +
+                              ") than initial clusters (" + to_string(num_initial_clusters) + ") to pair");
 
-        for (int j = 0; j < final_clusters_blocks.size(); j++)
+        for (int j = 0; j < num_final_clusters; j++)
             intersections[max_indices.first][j] = -1;
 
-        for(int k=0;k<initial_clusters_blocks.size(); ++k)
+        for(int k=0;k<num_initial_clusters; ++k)
             intersections[k][max_indices.second] = -1;
 
         workload_to_cluster_map[max_indices.first] = max_indices.second;
@@ -1093,10 +1983,9 @@ vector<set<int>> HierarchicalClustering::getBlocksInClusters(const vector<set<in
     for(const auto& cluster : clusters){
         set<int> cluster_blocks;
         for(const int file_index : cluster){
-            for (int fp_index = 0; fp_index < m_ds->getNumberOfFingerprintsForClustering(); ++fp_index) {
-                if (m_ds->isFileHasFingerprint(file_index, fp_index)) // if block exists in file - add it
-                    cluster_blocks.insert(fp_index);
-            }
+            m_ds->getFileBlocksIndex().forEachBlockInFile(file_index, [&cluster_blocks](const int fp_index){
+                cluster_blocks.insert(fp_index);
+            });
         }
 
         clusters_blocks.emplace_back(cluster_blocks);
@@ -1108,8 +1997,8 @@ vector<set<int>> HierarchicalClustering::getBlocksInClusters(const vector<set<in
 pair<int, int> HierarchicalClustering::findMax(vector<vector<int>> mat) {
     static constexpr int UNSET_VALUE = -1;
 
-    int maxX=UNSET_VALUE;
-    int maxY=UNSET_VALUE;
+    int maxX=NO_MAX_INDEX;
+    int maxY=NO_MAX_INDEX;
     int maxElement=UNSET_VALUE;
 
     // look for the largest intersection
@@ -1127,16 +2016,77 @@ pair<int, int> HierarchicalClustering::findMax(vector<vector<int>> mat) {
     return {maxX, maxY};
 }
 
-vector<set<int>> HierarchicalClustering::getCurrentClustering() const{
+vector<set<int>> HierarchicalClustering::getCurrentClustering(const ClusteringWorkspace& workspace) const{
+    // the final clusters are kept in the order of their indices, the greedy workload mapping depends on it
+    vector<int> active_clusters = workspace.active_clusters;
+    sort(active_clusters.begin(), active_clusters.end());
+
     vector<set<int>> result;
-    result.reserve(m_ds->getNumberOfFilesForClustering());
+    result.reserve(active_clusters.size());
+    for(const int cluster : active_clusters)
+        result.emplace_back(workspace.clusters[cluster]->getCurrentFiles());
+
+    return std::move(result);
+}
 
-    for(const auto& cluster : m_clusters){
-        if(cluster->isActivated())
-            result.emplace_back(cluster->getCurrentFiles());
+vector<set<int>> HierarchicalClustering::getRefinedClusters(const vector<set<int>>& clusters) const{
+    // per cluster, fingerprint's algo index to num of the cluster's files which contain it, and the cluster's size
+    const int num_fingerprints = m_ds->getAppearancesMatrix().getNumColumns();
+    vector<vector<int>> clusters_block_ref_count(clusters.size(), vector<int>(num_fingerprints, 0));
+    vector<long long> clusters_sizes(clusters.size(), 0);
+    for (int cluster = 0; cluster < clusters.size(); ++cluster) {
+        for (const int file_index : clusters[cluster]) {
+            m_ds->getFileBlocksIndex().forEachBlockInFile(file_index, [&](const int fp_index){
+                if (clusters_block_ref_count[cluster][fp_index]++ == 0)
+                    clusters_sizes[cluster] += m_ds->getFingerprintSize(fp_index);
+            });
+        }
     }
 
-    return std::move(result);
+    const long long max_cluster_size = clusters_sizes.empty() ? 0 : *max_element(clusters_sizes.cbegin(),
+                                                                                 clusters_sizes.cend());
+    vector<set<int>> refined_clusters = clusters;
+    vector<long long> shared_sizes(clusters.size());
+    for (int cluster = 0; cluster < clusters.size(); ++cluster) {
+        for (const int file_index : clusters[cluster]) {
+            if (refined_clusters[cluster].size() == 1)
+                break;
+
+            // the size of the file's blocks which every cluster holds besides the file itself
+            long long file_size = 0;
+            fill(shared_sizes.begin(), shared_sizes.end(), 0);
+            m_ds->getFileBlocksIndex().forEachBlockInFile(file_index, [&](const int fp_index){
+                const int fp_size = m_ds->getFingerprintSize(fp_index);
+                file_size += fp_size;
+                for (int other_cluster = 0; other_cluster < clusters.size(); ++other_cluster) {
+                    if (clusters_block_ref_count[other_cluster][fp_index] > (other_cluster == cluster ? 1 : 0))
+                        shared_sizes[other_cluster] += fp_size;
+                }
+            });
+
+            int best_cluster = cluster;
+            for (int other_cluster = 0; other_cluster < clusters.size(); ++other_cluster) {
+                if (shared_sizes[other_cluster] > shared_sizes[best_cluster] &&
+                    clusters_sizes[other_cluster] + file_size - shared_sizes[other_cluster] <= max_cluster_size)
+                    best_cluster = other_cluster;
+            }
+
+            if (best_cluster == cluster)
+                continue;
+
+            m_ds->getFileBlocksIndex().forEachBlockInFile(file_index, [&](const int fp_index){
+                if (--clusters_block_ref_count[cluster][fp_index] == 0)
+                    clusters_sizes[cluster] -= m_ds->getFingerprintSize(fp_index);
+                if (clusters_block_ref_count[best_cluster][fp_index]++ == 0)
+                    clusters_sizes[best_cluster] += m_ds->getFingerprintSize(fp_index);
+            });
+
+            refined_clusters[cluster].erase(file_index);
+            refined_clusters[best_cluster].insert(file_index);
+        }
+    }
+
+    return refined_clusters;
 }
 
 void HierarchicalClustering::outputIncrementalMigration(const string& file_path,
@@ -1173,33 +2123,182 @@ void HierarchicalClustering::outputIncrementalMigration(const string& file_path,
                                 is_valid_traffic, is_valid_lb);
 }
 
-bool HierarchicalClustering::performClustering(const ClusteringParams& clustering_params) {
-    resetDataStructures();
+bool HierarchicalClustering::performClustering(const ClusteringParams& clustering_params, ClusteringWorkspace& workspace,
+                                               const bool resume_from_checkpoint,
+                                               const function<bool()>& should_stop) {
+    const int num_leaves = m_super_nodes ? m_super_nodes->getNumberOfSuperNodes() :
+                                           m_ds->getNumberOfFilesForClustering();
+    const int num_removed_leaves = m_super_nodes ? 0 : m_ds->getNumberOfRemovedFiles();
+    int num_current_clusters = num_leaves - num_removed_leaves;
+    if (resume_from_checkpoint && workspace.checkpoint.is_valid) {
+        workspace.restoreCheckpoint();
+        num_current_clusters = workspace.checkpoint.num_current_clusters;
+    } else {
+        resetDataStructures(workspace);
+        preMergeClusters(clustering_params, workspace, num_current_clusters);
+        initRowsMergeOffers(clustering_params, workspace);
+        workspace.checkpoint.is_valid = false;
+    }
+
+    bool is_restricted_merge_found = false;
+    for (; num_current_clusters > clustering_params.number_of_clusters; num_current_clusters--) {
+        if (should_stop && should_stop())
+            return false;
 
-    const auto initial_file_to_cluster = m_ds->getInitialFileToClusterMapping();
-    const int num_files_for_clustering = m_ds->getNumberOfFilesForClustering();
-    const int num_removed_files = m_ds->getNumberOfRemovedFiles();
-    for (int num_current_clusters = num_files_for_clustering - num_removed_files; num_current_clusters > clustering_params.number_of_clusters; num_current_clusters--) {
         //resetDataStructures also disable all removed files
-        const ClustersMergeOffer chosen_merge_offer = findBestMerge(clustering_params, num_current_clusters,
-                                                                    num_files_for_clustering);
+        const RandomGenerator random_generator_before_merge = workspace.random_generator;
+        bool is_merge_restricted = false;
+        const ClustersMergeOffer chosen_merge_offer = findBestMerge(clustering_params, workspace, is_merge_restricted);
+
+        // the first merge which the load balance constraint restricted is where a retry with a wider margin may take
+        // another merge, checkpoint it (unless the execution resumed from it). the rows which findBestMerge completed
+        // hold the same smallest offers, so the state after it is as good as the state before it
+        if (m_resume_failed_clusterings && is_merge_restricted && !is_restricted_merge_found) {
+            is_restricted_merge_found = true;
+            if (!workspace.checkpoint.is_valid || workspace.checkpoint.num_current_clusters != num_current_clusters)
+                workspace.saveCheckpoint(random_generator_before_merge, num_current_clusters);
+        }
 
         // check if we did not find any suitable clusters to merge, and we are yet to receive number_of_clusters clusters
         if (chosen_merge_offer.weighted_dissimilarity == -1)
             return false;
 
         // merge the clusters we found and update our data structures
-        mergeClusters(chosen_merge_offer, initial_file_to_cluster);
+        mergeClusters(clustering_params, workspace, chosen_merge_offer);
     }
 
     return true;
 }
 
-void HierarchicalClustering::resetDataStructures() {
-    m_ds->resetDMDiagonal();
-    m_ds->resetDMBottomTriangle();
+int HierarchicalClustering::performSpeculativeClustering(const ClusteringParams& clustering_params,
+                                                         const double margin_iter, ClusteringWorkspace& workspace) {
+    while (workspace.speculative_workspaces.size() < m_num_speculative_margins)
+        workspace.speculative_workspaces.emplace_back(make_unique<ClusteringWorkspace>());
+
+    // the index of the smallest margin which succeeded so far, the clusterings of greater margins are cancelled
+    atomic<int> successful_margin_index(INT_MAX);
+    Utility::runInParallel(m_num_speculative_margins, m_num_speculative_margins,
+                           [&](const int margin_index, const int){
+        ClusteringParams margin_clustering_params = clustering_params;
+        margin_clustering_params.num_attempts = clustering_params.num_attempts + margin_index;
+        margin_clustering_params.internal_margin = margin_iter * pow(1 + clustering_params.eps / 100.0,
+                                                                     margin_clustering_params.num_attempts - 1);
+
+        ClusteringWorkspace& margin_workspace = *workspace.speculative_workspaces[margin_index];
+        resetDataStructures(margin_workspace);
+        // without a valid checkpoint the retry starts from singletons, continuing the workspace's random state as the
+        // sequential retries do
+        margin_workspace.random_generator = workspace.random_generator;
+        margin_workspace.checkpoint = workspace.checkpoint;
+        const bool is_successful = performClustering(margin_clustering_params, margin_workspace, true,
+                                                     [&successful_margin_index, margin_index](){
+            return successful_margin_index.load() < margin_index;
+        });
+
+        if (!is_successful)
+            return;
+
+        int current_successful_margin_index = successful_margin_index.load();
+        while (margin_index < current_successful_margin_index &&
+               !successful_margin_index.compare_exchange_weak(current_successful_margin_index, margin_index)) {}
+    });
+
+    if (successful_margin_index.load() != INT_MAX)
+        return successful_margin_index.load();
+
+    // the last margin's checkpoint is the furthest one, a retry with a greater margin can resume from it
+    workspace.checkpoint = workspace.speculative_workspaces[m_num_speculative_margins - 1]->checkpoint;
+    return -1;
+}
+
+void HierarchicalClustering::setNextAttemptMargin(ClusteringParams& clustering_params, const double margin_iter){
+    clustering_params.internal_margin = margin_iter * pow(1 + clustering_params.eps / 100.0,
+                                                          clustering_params.num_attempts);
+    clustering_params.num_attempts++;
+}
+
+HierarchicalClustering::PrecisionValidation HierarchicalClustering::validateDissimilaritiesPrecision(
+        ClusteringParams clustering_params, const double margin_iter, const RandomGenerator& random_generator,
+        ClusteringWorkspace& workspace, const ClusteringWorkspace& result_workspace){
+    if (!workspace.exact_workspace) {
+        workspace.exact_workspace = make_unique<ClusteringWorkspace>();
+        workspace.exact_workspace->use_exact_dissimilarities = true;
+    }
+
+    ClusteringWorkspace& exact_workspace = *workspace.exact_workspace;
+    exact_workspace.random_generator = random_generator;
+    bool is_clustering_successful = performClustering(clustering_params, exact_workspace, false);
+    while (!is_clustering_successful) {
+        setNextAttemptMargin(clustering_params, margin_iter);
+        is_clustering_successful = performClustering(clustering_params, exact_workspace, m_resume_failed_clusterings);
+    }
+
+    const vector<pair<int, int>>& merges = result_workspace.merges;
+    const vector<pair<int, int>>& exact_merges = exact_workspace.merges;
+    const auto different_merges = mismatch(merges.cbegin(), merges.cend(), exact_merges.cbegin(), exact_merges.cend());
+
+    // the same clusters may be kept by other cluster indices
+    vector<set<int>> clustering = getCurrentClustering(result_workspace);
+    vector<set<int>> exact_clustering = getCurrentClustering(exact_workspace);
+    sort(clustering.begin(), clustering.end());
+    sort(exact_clustering.begin(), exact_clustering.end());
+
+    PrecisionValidation validation;
+    validation.first_different_merge = different_merges.first == merges.cend() &&
+                                       different_merges.second == exact_merges.cend() ?
+                                       PrecisionValidation::NO_DIFFERENT_MERGE :
+                                       different_merges.first - merges.cbegin();
+    validation.num_merges = merges.size();
+    validation.num_exact_merges = exact_merges.size();
+    validation.is_same_clustering = clustering == exact_clustering;
+    validation.system_size = result_workspace.current_system_size;
+    validation.exact_system_size = exact_workspace.current_system_size;
+    return validation;
+}
+
+void HierarchicalClustering::resetDataStructures(ClusteringWorkspace& workspace) {
+    workspace.merges.clear();
+    if (workspace.ds_version == m_ds->getVersion()) {
+        rollbackModifiedClusters(workspace);
+        return;
+    }
+
+    // the dissimilarities matrix of m_ds (or of the super nodes) is never modified while clustering, it is the base of
+    // the workspace's matrix
+    workspace.ds = m_ds.get();
+    workspace.super_nodes = m_super_nodes.get();
+    const int num_leaves = workspace.getNumberOfLeaves();
+    workspace.cluster_overlay_row.assign(num_leaves, ClusteringWorkspace::NO_OVERLAY_ROW);
+    workspace.free_overlay_rows.clear();
+    for (int i = 0; i < workspace.getNumberOfOverlayRows(); ++i)
+        workspace.free_overlay_rows.push_back(i);
+
+    workspace.size_from_origin_clusters.resize(num_leaves);
+    for (int i = 0; i < num_leaves; ++i)
+        workspace.size_from_origin_clusters[i] = workspace.getLeafSizeFromOriginClusters(i);
+
+    // every cluster starts with the blocks of its file (or super node)
+    workspace.cluster_blocks = workspace.getLeavesBlocks();
+
+    // removed files are deactivated for as long as the version holds, they are not rolled back
+    workspace.is_cluster_modified.assign(num_leaves, false);
+    initClusters(workspace);
+    workspace.is_cluster_modified.assign(num_leaves, false);
+    workspace.modified_clusters.clear();
+
+    workspace.initial_system_size = workspace.current_system_size;
+    workspace.ds_version = m_ds->getVersion();
+}
+
+void HierarchicalClustering::runSweepWorkItems(const int num_work_items,
+                                               const function<void(const int, ClusteringWorkspace&)>& work_item_func) {
+    const int num_workers = std::min(m_num_threads, num_work_items);
+    while (m_workspaces.size() < num_workers)
+        m_workspaces.emplace_back(make_unique<ClusteringWorkspace>());
 
-    initClusters();
+    Utility::runInParallel(num_work_items, num_workers, [&](const int work_item, const int worker_index){
+        work_item_func(work_item, *m_workspaces[worker_index]);
+    });
 }
 
 double HierarchicalClustering::get_iter_margin(const bool is_converging_margin, const double final_target_margin,
@@ -5,7 +5,10 @@
 #include "Shared/AlgorithmDSManager.hpp"
 #include "Shared/GreedySplit.hpp"
 #include "Calculator/Calculator.hpp"
+#include "Shared/RandomGenerator.hpp"
+#include "Shared/SuperNodes.hpp"
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <utility>
@@ -20,10 +23,20 @@ class HierarchicalClustering final {
 private:
     struct ClustersMergeOffer;
     struct ClusteringParams;
+    struct ClusteringWorkspace;
+    struct PrecisionValidation;
+    struct SweepBudgetValidation;
 
 public:
     struct ClusteringResult;
 
+public:
+    // the warm start percent for clustering every iteration from single files
+    static constexpr int NO_WARM_START = 0;
+
+    // the sweep budget percent for fully evaluating every clustering of the sweep
+    static constexpr int FULL_SWEEP_BUDGET = 100;
+
 public:
     using resultCompareFunc = function<int(const shared_ptr<ClusteringResult>&, const shared_ptr<ClusteringResult>& )>;
 
@@ -32,8 +45,37 @@ public:
      * creates a new instance of Hierarchical Clustering
      * @param ds - a AlgorithmDSManager's object which contains all matrices and data structures for the algorithm
      * @param lb_sizes - sizes to load balance to, in case you're not using load balance, this argument can be anything
+     * @param num_threads - num of worker threads used to run the W_T x seed x gap sweep of every iteration
+     * @param resume_failed_clusterings - whether a load balanced clustering which fails is retried from its checkpoint
+     * (see performClustering) instead of from single files with the random generator continuing
+     * @param num_speculative_margins - num of margins tried concurrently once a load balanced clustering fails (every
+     * sweep thread uses that many threads for its retries), 1 for trying one margin at a time (relevant only with
+     * resume_failed_clusterings)
+     * @param warm_start_percent - % of the previous clustering's merges which every clustering may take as they are
+     * (the merges of clusters without removed files), NO_WARM_START for clustering from single files
+     * @param use_super_nodes - whether to use a two level clustering, which collapses the files into super nodes and
+     * clusters the super nodes (see SuperNodes). ds's dissimilarities matrix is not used in that case
+     * @param super_nodes_jaccard_threshold - the jaccard threshold of the super nodes, SuperNodes::BY_HOST to collapse
+     * the files by their host (relevant only with use_super_nodes)
+     * @param refine_super_nodes - whether to move the files on the boundaries between the final clusters once the
+     * super nodes are clustered (relevant only with use_super_nodes)
+     * @param validate_dissimilarities_precision - whether to run every clustering again on ds's exact dissimilarities
+     * and report the differences (ds should keep its exact dissimilarities, see validateDissimilaritiesPrecision)
+     * @param sweep_budget_percent - % of every sweep's clusterings which are fully evaluated (arranged and costed by the
+     * Calculator), the rest are dropped by their estimated cost (see getEstimatedClusteringCost). FULL_SWEEP_BUDGET for
+     * evaluating all of them
+     * @param validate_sweep_budget - whether to fully evaluate the dropped clusterings as well and report whether the
+     * best clustering of the full sweep survived (relevant only with a sweep budget)
      */
-    explicit HierarchicalClustering(std::unique_ptr<AlgorithmDSManager>& ds, const std::vector<double>& lb_sizes);
+    explicit HierarchicalClustering(std::unique_ptr<AlgorithmDSManager>& ds, const std::vector<double>& lb_sizes,
+                                    const int num_threads = 1, const bool resume_failed_clusterings = false,
+                                    const int num_speculative_margins = 1,
+                                    const int warm_start_percent = NO_WARM_START, const bool use_super_nodes = false,
+                                    const double super_nodes_jaccard_threshold = SuperNodes::BY_HOST,
+                                    const bool refine_super_nodes = false,
+                                    const bool validate_dissimilarities_precision = false,
+                                    const int sweep_budget_percent = FULL_SWEEP_BUDGET,
+                                    const bool validate_sweep_budget = false);
 
     HierarchicalClustering(const HierarchicalClustering&) = delete;
     HierarchicalClustering& operator=(const HierarchicalClustering&) = delete;
@@ -98,9 +140,57 @@ private:
     /**
      * perform the clustering process
      * @param clustering_params - clustering parameters
+     * @param workspace - the workspace to perform the clustering in
+     * @param resume_from_checkpoint - whether this is a retry of the previous (failed) execution with a wider margin,
+     * which resumes from the previous execution's checkpoint instead of starting from singletons (the checkpoints are
+     * saved only with m_resume_failed_clusterings). the merges before the checkpoint were not restricted by the load
+     * balance constraint, so a wider margin does not change them and the result is the same as a retry from singletons
+     * which starts from the previous execution's random state
+     * @param should_stop - in case it is given, checked before every merge and the process is stopped (as failed) once
+     * it returns true
      * @return - whether the process was successful or not
      */
-    bool performClustering(const ClusteringParams& clustering_params);
+    bool performClustering(const ClusteringParams& clustering_params, ClusteringWorkspace& workspace,
+                           const bool resume_from_checkpoint, const std::function<bool()>& should_stop = nullptr);
+
+    /**
+     * retries a failed clustering with the next m_num_speculative_margins margins concurrently, every margin in a
+     * speculative workspace of the given workspace which resumes from the given workspace's checkpoint. a margin's
+     * clustering is cancelled once a smaller margin succeeds, so the result is the same as retrying the margins one
+     * after another. in case all of them fail, the given workspace's checkpoint is replaced by the last margin's
+     * checkpoint
+     * @param clustering_params - clustering parameters of the next attempt (with the first margin to try)
+     * @param margin_iter - the margin of the first attempt
+     * @param workspace - the workspace of the failed clustering
+     * @return index (from 0) of the smallest margin which succeeded, its clustering is in
+     * workspace.speculative_workspaces[index]. -1 in case all of them failed
+     */
+    int performSpeculativeClustering(const ClusteringParams& clustering_params, const double margin_iter,
+                                     ClusteringWorkspace& workspace);
+
+    /**
+     * sets the margin of the next attempt of a failed clustering
+     * @param clustering_params - clustering parameters of the failed attempt
+     * @param margin_iter - the margin of the first attempt
+     */
+    static void setNextAttemptMargin(ClusteringParams& clustering_params, const double margin_iter);
+
+    /**
+     * validation of the dissimilarities' precision - runs a clustering again on ds's exact dissimilarities (see
+     * AlgorithmDSManager::getExactDissimilarityCell) from the same random state, retrying the margins one after
+     * another, and compares the merges and the clusters of both
+     * @param clustering_params - clustering parameters of the clustering's first attempt
+     * @param margin_iter - the margin of the first attempt
+     * @param random_generator - the random generator's state the clustering started with
+     * @param workspace - the workspace of the clustering's sweep work item, the exact clustering runs in its exact
+     * workspace
+     * @param result_workspace - the workspace which holds the clustering
+     * @return the differences between the clustering and the exact one
+     */
+    PrecisionValidation validateDissimilaritiesPrecision(ClusteringParams clustering_params, const double margin_iter,
+                                                         const RandomGenerator& random_generator,
+                                                         ClusteringWorkspace& workspace,
+                                                         const ClusteringWorkspace& result_workspace);
 
     /**
 
@@ -114,23 +204,127 @@ private:
             const int32_t current_change_iter,const int32_t current_total_iter, const bool use_new_dist_metric);
 
     /**
-     * reset our data structures for the next execution of the algorithm
+     * @param num_clusterings - num of clusterings of a sweep
+     * @return num of the sweep's clusterings which are fully evaluated within m_sweep_budget_percent (at least 1)
+     */
+    int getNumOfClusteringsInSweepBudget(const int num_clusterings) const;
+
+    /**
+     * @param initial_clusters - the initial clustering, every set is a cluster of files
+     * @return the blocks of every initial cluster (row i is cluster i, column j is fingerprint j), of the fingerprints
+     * of ds's appearances matrix
      */
-    void resetDataStructures();
+    BitMatrix getInitialClustersBlocks(const std::vector<std::set<int>>& initial_clusters) const;
 
     /**
-     * initialize the clusters vector
+     * estimates the cost of the clustering in the given workspace without arranging it: the blocks of the clusters are
+     * taken from the workspace, so only the fingerprints of ds's appearances matrix are counted (scaled to ds's system
+     * size), and the workloads are mapped to the clusters greedily by their shared fingerprints. the traffic is the
+     * size of the blocks every workload receives, and the refinement of super nodes is not taken into account
+     * @param workspace - the workspace which holds the clustering
+     * @param initial_clusters_blocks - the blocks of every initial cluster (see getInitialClustersBlocks)
+     * @param allowed_traffic_bytes - the allowed traffic of the clustering
+     * @param margin - the load balance margin of the clustering
+     * @param load_balance - whether load balance is in use
+     * @return the estimated cost, which has no volumes' info
      */
-    void initClusters();
+    std::shared_ptr<Calculator::CostResult> getEstimatedClusteringCost(const ClusteringWorkspace& workspace,
+                                                                       const BitMatrix& initial_clusters_blocks,
+                                                                       const long long int allowed_traffic_bytes,
+                                                                       const double margin,
+                                                                       const bool load_balance) const;
 
     /**
+     * @param estimated_result - a clustering result of the sweep with its estimated cost and without its mapping
      * @param initial_clusters - initial clusters as vector of sets
-     * @return the calculated clustering result of our execution in a format of
-     * mapping between workload name to its final files
+     * @param final_clusters - the result's final clusters
+     * @return the result with its arranged mapping and without a cost
+     */
+    std::shared_ptr<ClusteringResult> getArrangedSweepResult(const ClusteringResult& estimated_result,
+                                                             const std::vector<std::set<int>>& initial_clusters,
+                                                             const std::vector<std::set<int>>& final_clusters) const;
+
+    /**
+     * first part of the validation of the sweep budget - fully evaluates the sweep's dropped clusterings, which are
+     * compared with the evaluated results once those are costed (see validateSweepBudget)
+     * @param estimated_results - the sweep's results with their estimated costs
+     * @param estimated_ranking - indices of estimated_results from the best estimated cost to the worst
+     * @param num_evaluated_clusterings - num of the first clusterings of estimated_ranking which were evaluated
+     * @param final_clusters - the final clusters of every result of estimated_results
+     * @param initial_clusters - initial clusters as vector of sets
+     * @param current_change_iter - the current change iteration
+     * @param load_balance - whether load balance is in use
+     * @param use_cache - whether to cache in calc
+     * @param cache_path - path to cost's cache (if use_cache=true)
+     * @param allowed_traffic_bytes - the allowed traffic of the clusterings
+     * @param margin - the load balance margin of the clusterings
+     * @return the costed dropped results and the estimated ranks of the evaluated results
+     */
+    std::unique_ptr<SweepBudgetValidation> getSweepBudgetValidation(
+            const std::vector<std::shared_ptr<ClusteringResult>>& estimated_results,
+            const std::vector<int>& estimated_ranking, const int num_evaluated_clusterings,
+            const std::vector<std::vector<std::set<int>>>& final_clusters,
+            const std::vector<std::set<int>>& initial_clusters, const int current_change_iter,
+            const bool load_balance, const bool use_cache, const std::string& cache_path,
+            const long long int allowed_traffic_bytes, const double margin);
+
+    /**
+     * validation of the sweep budget - reports whether the best result of the full sweep is one of the evaluated
+     * results and how the best evaluated result compares, by the dropped results of m_sweep_budget_validation (which
+     * is cleared). does nothing in case the last sweep was not validated
+     * @param evaluated_results - the evaluated results and the "do nothing" result (last) in the order of the sweep,
+     * once their costs are calculated. they are not changed
+     */
+    void validateSweepBudget(const std::vector<std::shared_ptr<ClusteringResult>>& evaluated_results);
+
+    /**
+     * runs the given work items of a clustering sweep, each work item in a workspace of its own
+     * @param num_work_items - num of work items to run
+     * @param work_item_func - function which executes a single work item (by its index) in the given workspace
+     *
+     * the work items are spread between up to m_num_threads threads. the first exception thrown by a work item is
+     * rethrown once all threads are done
+     */
+    void runSweepWorkItems(const int num_work_items,
+                           const std::function<void(const int, ClusteringWorkspace&)>& work_item_func);
+
+    /**
+     * reset the given workspace's data structures for the next execution of the algorithm. in case the clustering
+     * inputs did not change since the workspace was initialized only the clusters modified by the previous execution
+     * are restored, otherwise the workspace is initialized again
+     * @param workspace - a clustering workspace
+     */
+    void resetDataStructures(ClusteringWorkspace& workspace);
+
+    /**
+     * initialize the clusters vector of the given workspace
+     * @param workspace - a clustering workspace
+     */
+    void initClusters(ClusteringWorkspace& workspace);
+
+    /**
+     * restores the clusters in the given workspace's modified clusters log to their initial state, the work is
+     * proportional to the num of merges of the previous execution
+     * @param workspace - a clustering workspace
+     */
+    void rollbackModifiedClusters(ClusteringWorkspace& workspace);
+
+    /**
+     * @param workspace - the workspace the clustering was performed in
+     * @return the final clusters of our execution (refined in case of refined super nodes)
      *
      * Should be called only after a successful performClustering
+     */
+    std::vector<std::set<int>> getFinalClusters(const ClusteringWorkspace& workspace) const;
+
+    /**
+     * @param initial_clusters - initial clusters as vector of sets
+     * @param final_clusters - the final clusters of our execution (see getFinalClusters)
+     * @return the calculated clustering result of our execution in a format of
+     * mapping between workload name to its final files
     */
-    std::shared_ptr<std::map<std::string, std::set<int>>> getClusteringResult(const std::vector<std::set<int>>& initial_clusters) const;
+    std::shared_ptr<std::map<std::string, std::set<int>>> getClusteringResult(const std::vector<std::set<int>>& initial_clusters,
+                                                                            const std::vector<std::set<int>>& final_clusters) const;
 
     /**
      * @param final_clusters - the final clustering
@@ -144,70 +338,146 @@ private:
     /**
      * activates only in case load balancing is in use
      * @param clustering_params - clustering parameters
+     * @param workspace - a clustering workspace
      * @param cluster1 - a cluster 1 index
      * @param cluster2 - a cluster 2 index
      * @return whether a merge between the clusters 1+2 is valid, size wise
      */
-    bool isValidClustersMerge(const ClusteringParams& clustering_params, const int cluster1, const int cluster2) const;
+    bool isValidClustersMerge(const ClusteringParams& clustering_params, const ClusteringWorkspace& workspace,
+                              const int cluster1, const int cluster2) const;
 
     /**
+     * @param workspace - a clustering workspace
      * @param cluster1 - a cluster 1 index
      * @param cluster2 - a cluster 2 index
-     * @return the size of the cluster in case clusters 1 +2 are merged
+     * @return the size of the cluster in case clusters 1 +2 are merged, size(1) + size(2) - size(1 and 2 shared blocks)
      */
-    double getMergedClusterSize(const int cluster1, const int cluster2) const;
+    double getMergedClusterSize(const ClusteringWorkspace& workspace, const int cluster1, const int cluster2) const;
 
     /**
-     * @param files_indices - set of cluster's files indexes
-     * @return the size of the given cluster
+     * @param file_index - a file index
+     * @return the size of the given file's blocks, the size of the file's cluster before any merge
      */
-    int getClusterSize(const std::set<int>& files_indices) const;
+    long long getFileBlocksSize(const int file_index) const;
 
     /**
      * finds a random merge offer within the merge offers with the smallest dissimilarity value
-     * (in the lower triangular of dissimilarity_matrix)
+     * (in the lower triangular of dissimilarity_matrix), using the rows' merge offers kept in the workspace
      *
      * @param clustering_params - clustering parameters
+     * @param workspace - a clustering workspace
+     * @param is_merge_restricted - set to whether the load balance constraint rejected any of the visited merge offers
      * @return a random merge offer from the smallest merge offers
      */
-    ClustersMergeOffer findBestMerge(const ClusteringParams& clustering_params, const int num_current_clusters,
-                                     const int num_files_for_clustering);
+    ClustersMergeOffer findBestMerge(const ClusteringParams& clustering_params, ClusteringWorkspace& workspace,
+                                     bool& is_merge_restricted);
 
     /**
      * performs complete linkage hierarchical clustering
+     * @param workspace - a clustering workspace
+     * @param merge_offer - the chosen merge offer
+     */
+    void completeLinkage(ClusteringWorkspace& workspace, const ClustersMergeOffer& merge_offer);
+
+    /**
+     * complete linkage of the candidate cells (in case only the candidate cells are kept): the merged cluster is a
+     * candidate pair only with the clusters which were candidates of both its clusters. the clusters which were
+     * candidates of any of them are kept in the workspace's merge_neighbours
+     * @param workspace - a clustering workspace
      * @param merge_offer - the chosen merge offer
-     * @param file_to_cluster - initial file to cluster mapping
      */
-    void completeLinkage(const ClustersMergeOffer& merge_offer, const std::unordered_map<int,int>& file_to_cluster);
+    static void completeCandidateCellsLinkage(ClusteringWorkspace& workspace, const ClustersMergeOffer& merge_offer);
 
     /**
      * merges the clusters in the given merge_offer (random merge offer within the merge offers with the smallest
      * dissimilarity value)
      *
+     * @param clustering_params - clustering parameters
+     * @param workspace - a clustering workspace
      * @param merge_offer - the chosen merge offer
-     * @param file_to_cluster - initial file_to_cluster mapping
      */
-    void mergeClusters(const ClustersMergeOffer& merge_offer, const std::unordered_map<int,int>& file_to_cluster);
+    void mergeClusters(const ClusteringParams& clustering_params, ClusteringWorkspace& workspace,
+                       const ClustersMergeOffer& merge_offer);
 
     /**
-     * inner function for considering a new merge offer between cluster 1 and cluster 2 when we already have merge
-     * offers in the given sorted_merge_offers
-     * @param cluster1 - a cluster index
-     * @param cluster2 - a cluster index
-     * @param sorted_merge_offers - vector of the 'best' merge offers
+     * merges the clusters in the given merge_offer without updating the rows' merge offers
+     * @param workspace - a clustering workspace
+     * @param merge_offer - the merge offer
+     */
+    void mergeClustersWithoutMergeOffers(ClusteringWorkspace& workspace, const ClustersMergeOffer& merge_offer);
+
+    /**
+     * merges the warm start merges (m_warm_start_merges) as they are, as long as there are more than the requested
+     * num of clusters. should be called right after resetDataStructures, before the rows' merge offers are initialized
+     * @param clustering_params - clustering parameters
+     * @param workspace - a clustering workspace
+     * @param num_current_clusters - the current num of clusters, decreased by the num of merges
+     */
+    void preMergeClusters(const ClusteringParams& clustering_params, ClusteringWorkspace& workspace,
+                          int& num_current_clusters);
+
+    /**
+     * @return the merges of the previous clustering which the current clustering starts with: the merges within the
+     * first m_warm_start_percent % of the previous clustering's merges, whose clusters contain no file which was
+     * removed since. files added since are not in any of them, they start as single files
+     */
+    std::vector<std::pair<int, int>> getWarmStartMerges() const;
+
+    /**
+     * inner function for considering a new merge offer when we already have merge offers in the given
+     * sorted_merge_offers
+     * @param sorted_merge_offers - vector of the 'best' merge offers, kept as a max heap (max value at front)
+     * @param max_results_size - max num of merge offers to keep
+     * @param merge_offer - the new merge offer
+     */
+    static void updateSortedMergeOffers(std::vector<ClustersMergeOffer>& sorted_merge_offers,
+                                        const int max_results_size,
+                                        const ClustersMergeOffer& merge_offer);
+
+    /**
+     * calculates the merge offers of the given row of the dissimilarities matrix (the row's cluster with every cluster
+     * of a smaller index) and keeps them sorted in ascending order in the workspace
      * @param clustering_params - clustering parameters
+     * @param workspace - a clustering workspace
+     * @param row - a cluster index
+     * @param keep_all_offers - whether to keep all the row's merge offers or only the max_results_size best of them
      */
-    void updateSortedMergeOffers(const ClusteringParams& clustering_params,
-                                 std::vector<ClustersMergeOffer>&  sorted_merge_offers,
-                                 const int cluster1,
-                                 const int cluster2,
-                                 const int num_current_clusters,
-                                 const int num_files_for_clustering);
+    void calcRowMergeOffers(const ClusteringParams& clustering_params, ClusteringWorkspace& workspace,
+                            const int row, const bool keep_all_offers) const;
 
     /**
+     * calculates the best merge offers of every row of the dissimilarities matrix
+     * @param clustering_params - clustering parameters
+     * @param workspace - a clustering workspace
+     */
+    void initRowsMergeOffers(const ClusteringParams& clustering_params, ClusteringWorkspace& workspace) const;
+
+    /**
+     * updates the rows' merge offers after the given merge, only rows which hold an offer with one of the merged
+     * clusters are affected
+     * @param clustering_params - clustering parameters
+     * @param workspace - a clustering workspace
+     * @param merge_offer - the merge offer which was just performed
+     */
+    void updateRowsMergeOffers(const ClusteringParams& clustering_params, ClusteringWorkspace& workspace,
+                               const ClustersMergeOffer& merge_offer) const;
+
+    /**
+     * @param workspace - a clustering workspace
      * @return the current clustering result where every set in the given vector is a cluster
      */
-    std::vector<std::set<int>> getCurrentClustering() const;
+    std::vector<std::set<int>> getCurrentClustering(const ClusteringWorkspace& workspace) const;
+
+    /**
+     * refines the boundaries between the clusters of a two level clustering, where the files of a super node always
+     * end up in the same cluster: every file which shares more blocks (by size) with another cluster than with the
+     * rest of its own cluster moves to the cluster it shares the most with. a move never makes the destination larger
+     * than the largest cluster before the refinement, and never leaves a cluster empty. the moves do not keep the
+     * clusters load balanced, so it is not used with load balance
+     * @param clusters - the clusters, every set is a cluster
+     * @return the refined clusters, in the same order
+     */
+    std::vector<std::set<int>> getRefinedClusters(const std::vector<std::set<int>>& clusters) const;
 
     /**
      * ClustersMergeOffer's ascending sort function
@@ -221,9 +491,17 @@ private:
      * @param cluster1 - a cluster index
      * @param cluster2 - a cluster index
      * @param clustering_params - clustering parameters
+     * @param workspace - a clustering workspace
      */
-    double getDistanceBetweenClusters(const ClusteringParams& clustering_params, const int cluster1,
-                                      const int cluster2);
+    double getDistanceBetweenClusters(const ClusteringParams& clustering_params, const ClusteringWorkspace& workspace,
+                                      const int cluster1, const int cluster2) const;
+
+    /**
+     * same as getDistanceBetweenClusters, with the clusters' jaccard distance already read from their cell
+     * @param jaccard_distance - the jaccard distance between the clusters
+     */
+    double getDistanceBetweenClusters(const ClusteringParams& clustering_params, const ClusteringWorkspace& workspace,
+                                      const int cluster1, const int cluster2, const double jaccard_distance) const;
 
     /**
      * returns the gravity forcebetween two clusters
@@ -246,13 +524,14 @@ private:
 
     /**
      * @param max_number_of_clusters - total num of clusters
-     * @param diss_cell - dissimilarity cell of the cluster we want to calculate its physical distance
+     * @param size_from_origin_clusters - the size the cluster we want to calculate its physical distance holds from
+     * every origin cluster
      * @param W_T - weighted traffic
      * @return the physical distance of the relevant cluster
      */
     double getPhysicalDistanceOfCluster(const int max_number_of_clusters,
-                                        const AlgorithmDSManager::DissimilarityCell& diss_cell,
-                                        const double W_T, const bool use_new_dist_metric);
+                                        const OriginClustersSizes& size_from_origin_clusters,
+                                        const double W_T, const bool use_new_dist_metric) const;
 
     /**
      * @param initial_clusters - the initial clustering
@@ -297,21 +576,35 @@ private:
             const std::vector<std::set<int>>& clusters1_blocks,
             const std::vector<std::set<int>>& clusters2_blocks);
 
+    // the indices findMax returns once every cell of the matrix is paired
+    static constexpr int NO_MAX_INDEX = -1;
+
     /**
      * finds the best suited cluster and original volume to match in our assignment of cluster to volumes
      * @param mat - the matrix of blocks' number intersection between clusters and original volumes
-     * @return the best suited cluster and original volume to match
+     * @return the best suited cluster and original volume to match, {NO_MAX_INDEX, NO_MAX_INDEX} in case every cell
+     * is paired (-1)
      */
     static std::pair<int, int> findMax(std::vector<std::vector<int>> mat);
 
+    /**
+     * pairs every initial cluster with a final cluster, the pair with the largest intersection first
+     * @param intersections - an intersection matrix where every cell [i,j] holds the intersection between initial
+     * cluster i and final cluster j
+     * @return index i is the final cluster of the i'th initial cluster. throws in case there are fewer final clusters
+     * than initial clusters
+     */
+    static std::vector<int> getGreedyMapping(std::vector<std::vector<int>> intersections);
+
     /**
      * @param sorted_merge_offers - list of sorted merge offers
      * @param gap - gap param of the clustering
+     * @param random_generator - the random generator to draw the offer with
      * @return a randomized offer from all offers in sorted_merge_offers that within the gap range
      */
     static ClustersMergeOffer randClustersMergeOfferFromVector(
             const std::vector<ClustersMergeOffer>& sorted_merge_offers,
-            const double gap);
+            const double gap, RandomGenerator& random_generator);
 
     void outputBestIncrementalStepResult( const string &output_path_prefix, const double traffic,
                                           int num_incremental_iter,int num_total_iter,int num_change_iter,
@@ -333,17 +626,93 @@ private:
     double get_iter_margin(const bool is_converging_margin, const double final_target_margin,
                            const unsigned int num_iter, const unsigned int num_of_iterations);
 
-    // m_clusters - list of nodes which represent the cluster. each cluster contains set of all the files in it
     // m_lb_sizes - sizes to load balance to, relevant for load balance only
     // m_ds - a AlgorithmDSManager's object which contains all the data structures for the algorithm
+    // m_num_threads - num of threads used to run the clustering sweep
+    // m_resume_failed_clusterings - whether a failed load balanced clustering is retried from its checkpoint
+    // m_num_speculative_margins - num of margins tried concurrently once a load balanced clustering fails
+    // m_warm_start_percent - % of the previous clustering's merges to start from, NO_WARM_START for none
+    // m_use_super_nodes - whether the clustering is of super nodes (a two level clustering)
+    // m_super_nodes_jaccard_threshold - the jaccard threshold of the super nodes, SuperNodes::BY_HOST for hosts
+    // m_refine_super_nodes - whether to refine the boundaries between the clusters of the super nodes
+    // m_validate_dissimilarities_precision - whether every clustering is validated against an exact clustering
+    // m_sweep_budget_percent - % of every sweep's clusterings which are fully evaluated, FULL_SWEEP_BUDGET for all
+    // m_validate_sweep_budget - whether every sweep is validated against the full evaluation of all its clusterings
+    // m_num_validated_sweeps - num of sweeps validated so far
+    // m_num_surviving_best_results - num of the validated sweeps whose best result of the full sweep was evaluated
+    // m_sweep_budget_validation - the dropped clusterings of the last sweep, kept until its evaluated results are
+    //                             costed (only with m_validate_sweep_budget)
+    // m_workspaces - a clustering workspace per thread, kept between sweeps to reuse its allocations
+    // m_previous_dendrogram - the merges of the best clustering so far (the last one chosen)
+    // m_warm_start_merges - the merges every clustering of the current sweep starts with
+    // m_super_nodes - the super nodes of the current version of m_ds (only with m_use_super_nodes)
 private:
-    double m_current_system_size;
-    std::vector<std::unique_ptr<Node>> m_clusters;
     const std::vector<double> m_lb_sizes;
     const std::unique_ptr<AlgorithmDSManager> m_ds;
+    const int m_num_threads;
+    const bool m_resume_failed_clusterings;
+    const int m_num_speculative_margins;
+    const int m_warm_start_percent;
+    const bool m_use_super_nodes;
+    const double m_super_nodes_jaccard_threshold;
+    const bool m_refine_super_nodes;
+    const bool m_validate_dissimilarities_precision;
+    const int m_sweep_budget_percent;
+    const bool m_validate_sweep_budget;
+    int m_num_validated_sweeps;
+    int m_num_surviving_best_results;
+    std::unique_ptr<SweepBudgetValidation> m_sweep_budget_validation;
+    std::vector<std::unique_ptr<ClusteringWorkspace>> m_workspaces;
+    std::shared_ptr<const std::vector<std::pair<int, int>>> m_previous_dendrogram;
+    std::vector<std::pair<int, int>> m_warm_start_merges;
+    std::unique_ptr<SuperNodes> m_super_nodes;
 };
 
 
+struct HierarchicalClustering::ClustersMergeOffer final{
+public:
+    ClustersMergeOffer(double weighted_dissimilarity, int cluster1, int cluster2):
+            weighted_dissimilarity(weighted_dissimilarity), cluster1(cluster1), cluster2(cluster2)
+    {
+    }
+
+public:
+    double weighted_dissimilarity;
+    int cluster1;
+    int cluster2;
+};
+
+struct HierarchicalClustering::PrecisionValidation final{
+public:
+    // the first different merge of clusterings with the same merges
+    static constexpr int NO_DIFFERENT_MERGE = -1;
+
+// first_different_merge - index of the first merge which differs from the exact clustering's, NO_DIFFERENT_MERGE in
+//                         case all the merges are the same
+// num_merges - num of merges of the clustering
+// num_exact_merges - num of merges of the exact clustering
+// is_same_clustering - whether both clusterings have the same clusters (the same cost)
+// system_size - the system size of the clustering
+// exact_system_size - the system size of the exact clustering
+public:
+    int first_different_merge;
+    int num_merges;
+    int num_exact_merges;
+    bool is_same_clustering;
+    double system_size;
+    double exact_system_size;
+};
+
+struct HierarchicalClustering::SweepBudgetValidation final{
+// dropped_results - the sweep's dropped clusterings with their costs, from the best estimated cost to the worst
+// evaluated_estimated_ranks - the estimated rank of every evaluated clustering, in the order of the sweep
+// num_clusterings - num of clusterings of the sweep
+public:
+    std::vector<std::shared_ptr<ClusteringResult>> dropped_results;
+    std::vector<int> evaluated_estimated_ranks;
+    int num_clusterings;
+};
+
 struct HierarchicalClustering::ClusteringParams final{
 public:
     ClusteringParams(
@@ -402,6 +771,399 @@ public:
     const string server_name;
 };
 
+struct HierarchicalClustering::ClusteringWorkspace final{
+public:
+    ClusteringWorkspace() : current_system_size(0), initial_system_size(0), ds(nullptr), super_nodes(nullptr),
+                            use_exact_dissimilarities(false), ds_version(-1) {}
+
+    ClusteringWorkspace(const ClusteringWorkspace&) = delete;
+    ClusteringWorkspace& operator=(const ClusteringWorkspace&) = delete;
+    ~ClusteringWorkspace() = default;
+
+public:
+    static constexpr int NO_OVERLAY_ROW = -1;
+    static constexpr int DEACTIVATED_CLUSTER = -2;
+    static constexpr int NOT_ACTIVE_CLUSTER = -1;
+    static const AlgorithmDSManager::DissimilarityCell DEACTIVATED_CELL;
+
+    // (cluster index, cell) of every candidate pair of a cluster, ordered by the cluster index
+    using CandidateCells = std::vector<std::pair<int, AlgorithmDSManager::DissimilarityCell>>;
+
+    /**
+     * @return whether only the cells of the LSH candidate pairs are kept (see AlgorithmDSManager::isUsingLsh), the
+     *         overlay rows are candidate_overlay_rows in that case
+     */
+    bool useCandidateCells() const{
+        return !super_nodes && ds->isUsingLsh();
+    }
+
+    /**
+     * the workspace's dissimilarities matrix is the dissimilarities matrix of the leaves (see getNumberOfLeaves) with
+     * an overlay row for every cluster which absorbed another cluster, cells of deactivated clusters are DBL_MAX
+     * @param cluster1 - a cluster index
+     * @param cluster2 - a cluster index
+     * @return the dissimilarity cell between cluster1 and cluster2 in the workspace's dissimilarities matrix
+     */
+    AlgorithmDSManager::DissimilarityCell getDissimilarityCell(const int cluster1, const int cluster2) const{
+        const int overlay_row1 = cluster_overlay_row[cluster1];
+        const int overlay_row2 = cluster_overlay_row[cluster2];
+        if (overlay_row1 == DEACTIVATED_CLUSTER || overlay_row2 == DEACTIVATED_CLUSTER)
+            return DEACTIVATED_CELL;
+
+        if (useCandidateCells()) {
+            const AlgorithmDSManager::DissimilarityCell* const candidate_cell = findCandidateCell(cluster1, cluster2);
+            return candidate_cell ? *candidate_cell : AlgorithmDSManager::NON_CANDIDATE_CELL;
+        }
+
+        // overlay rows are kept symmetric, so any of the clusters' overlay rows holds the cell
+        if (overlay_row1 != NO_OVERLAY_ROW)
+            return overlay_rows[overlay_row1][cluster2];
+
+        if (overlay_row2 != NO_OVERLAY_ROW)
+            return overlay_rows[overlay_row2][cluster1];
+
+        return getLeavesDissimilarityCell(cluster1, cluster2);
+    }
+
+    /**
+     * the clusters start as the leaves of the dendrogram: the files of ds, or the super nodes of a two level clustering
+     * @return num of leaves (removed files included)
+     */
+    int getNumberOfLeaves() const{
+        return super_nodes ? super_nodes->getNumberOfSuperNodes() : ds->getNumberOfFilesForClustering();
+    }
+
+    /**
+     * @param leaf - a leaf index
+     * @return the size the leaf holds from its origin clusters
+     */
+    const OriginClustersSizes& getLeafSizeFromOriginClusters(const int leaf) const{
+        return super_nodes ? super_nodes->getSizeFromOriginClusters(leaf) : ds->getFileSizeFromOriginClusters(leaf);
+    }
+
+    /**
+     * @return the blocks of every leaf (row i is leaf i, column j is fingerprint j)
+     */
+    const BitMatrix& getLeavesBlocks() const{
+        return super_nodes ? super_nodes->getBlocks() : ds->getAppearancesMatrix();
+    }
+
+    /**
+     * @param leaf1 - a leaf index
+     * @param leaf2 - a leaf index
+     * @return the dissimilarity cell between the leaves (the base of the workspace's dissimilarities matrix)
+     */
+    AlgorithmDSManager::DissimilarityCell getLeavesDissimilarityCell(const int leaf1, const int leaf2) const{
+        if (super_nodes)
+            return super_nodes->getDissimilarityCell(leaf1, leaf2);
+
+        if (use_exact_dissimilarities)
+            return ds->getExactDissimilarityCell(leaf1, leaf2);
+
+        return ds->getDissimilarityCell(leaf1, leaf2);
+    }
+
+    /**
+     * hints that the leaves' rows of the given clusters are about to be scanned, so they are fetched ahead of the scan
+     * (relevant only in case the files' dissimilarities matrix is in a memory mapped file)
+     * @param first_row - first cluster index
+     * @param last_row - one past the last cluster index
+     */
+    void prefetchLeavesRows(const int first_row, const int last_row) const{
+        if (!super_nodes)
+            ds->prefetchDissimilarityRows(first_row, last_row);
+    }
+
+    /**
+     * calls cell_func(j, cell) for every active cluster j < row, in no particular order. the row's cells are read in
+     * place instead of looking up every cell. in case only the candidate cells are kept, only the active clusters which
+     * are a candidate pair with row are visited
+     * @param row - a cluster index
+     * @param cell_func - callable which receives a cluster index and the dissimilarity cell between it and row
+     */
+    template<typename CellFunc>
+    void forEachActiveCellInRow(const int row, CellFunc cell_func) const{
+        if (cluster_overlay_row[row] == DEACTIVATED_CLUSTER)
+            return;
+
+        if (useCandidateCells()) {
+            forEachActiveCandidateCell(row, row, cell_func);
+            return;
+        }
+
+        // scan whichever is shorter, the clusters before row or the active clusters
+        if (row <= active_clusters.size()) {
+            for (int j = 0; j < row; ++j) {
+                if (cluster_overlay_row[j] != DEACTIVATED_CLUSTER)
+                    visitActiveCellInRow(row, j, cell_func);
+            }
+        } else {
+            for (const int j : active_clusters) {
+                if (j < row)
+                    visitActiveCellInRow(row, j, cell_func);
+            }
+        }
+    }
+
+    /**
+     * calls cell_func(j, cell) with the dissimilarity cell between row and j, both of them must be active
+     * @param row - a cluster index
+     * @param j - a cluster index
+     * @param cell_func - callable which receives a cluster index and the dissimilarity cell between it and row
+     */
+    template<typename CellFunc>
+    void visitActiveCellInRow(const int row, const int j, CellFunc& cell_func) const{
+        const int row_overlay_row = cluster_overlay_row[row];
+        const int overlay_row = cluster_overlay_row[j];
+        if (row_overlay_row != NO_OVERLAY_ROW)
+            cell_func(j, overlay_rows[row_overlay_row][j]);
+        else if (overlay_row != NO_OVERLAY_ROW)
+            cell_func(j, overlay_rows[overlay_row][row]);
+        else
+            cell_func(j, getLeavesDissimilarityCell(row, j));
+    }
+
+    /**
+     * calls cell_func(j, cell) for every active cluster j < end_cluster which is a candidate pair with the given
+     * cluster, in ascending order (relevant only in case only the candidate cells are kept)
+     * @param cluster_index - an active cluster index
+     * @param end_cluster - one past the last cluster index to visit
+     * @param cell_func - callable which receives a cluster index and the dissimilarity cell between it and the cluster
+     */
+    template<typename CellFunc>
+    void forEachActiveCandidateCell(const int cluster_index, const int end_cluster, CellFunc& cell_func) const{
+        // overlay rows hold only active clusters
+        const int overlay_row = cluster_overlay_row[cluster_index];
+        if (overlay_row == DEACTIVATED_CLUSTER)
+            return;
+
+        if (overlay_row != NO_OVERLAY_ROW) {
+            for (const auto& cell : candidate_overlay_rows[overlay_row]) {
+                if (cell.first >= end_cluster)
+                    break;
+
+                cell_func(cell.first, cell.second);
+            }
+
+            return;
+        }
+
+        for (const auto& cell : ds->getCandidateCells(cluster_index)) {
+            if (cell.first >= end_cluster)
+                break;
+
+            // the cell of a cluster which absorbed another cluster is in its overlay row, the pair is not a candidate
+            // pair anymore in case it is not there
+            const int j_overlay_row = cluster_overlay_row[cell.first];
+            if (j_overlay_row == NO_OVERLAY_ROW) {
+                cell_func(cell.first, cell.second);
+            } else if (j_overlay_row != DEACTIVATED_CLUSTER) {
+                const AlgorithmDSManager::DissimilarityCell* const overlay_cell =
+                        findCandidateCell(candidate_overlay_rows[j_overlay_row], cluster_index);
+                if (overlay_cell)
+                    cell_func(cell.first, *overlay_cell);
+            }
+        }
+    }
+
+    /**
+     * @param cluster1 - an active cluster index
+     * @param cluster2 - an active cluster index
+     * @return the cell of the candidate pair (cluster1, cluster2), null in case it is not a candidate pair (relevant
+     *         only in case only the candidate cells are kept)
+     */
+    const AlgorithmDSManager::DissimilarityCell* findCandidateCell(const int cluster1, const int cluster2) const{
+        if (cluster_overlay_row[cluster1] != NO_OVERLAY_ROW)
+            return findCandidateCell(candidate_overlay_rows[cluster_overlay_row[cluster1]], cluster2);
+
+        if (cluster_overlay_row[cluster2] != NO_OVERLAY_ROW)
+            return findCandidateCell(candidate_overlay_rows[cluster_overlay_row[cluster2]], cluster1);
+
+        return findCandidateCell(ds->getCandidateCells(cluster1), cluster2);
+    }
+
+    /**
+     * @param cells - candidate cells ordered by the cluster index
+     * @param cluster_index - a cluster index
+     * @return the cell of the given cluster in cells, null in case it is not there
+     */
+    static const AlgorithmDSManager::DissimilarityCell* findCandidateCell(const CandidateCells& cells,
+                                                                          const int cluster_index){
+        const auto cell_it = std::lower_bound(cells.cbegin(), cells.cend(), cluster_index,
+                                              [](const std::pair<int, AlgorithmDSManager::DissimilarityCell>& cell,
+                                                 const int cell_cluster){
+            return cell.first < cell_cluster;
+        });
+
+        return cell_it != cells.cend() && cell_it->first == cluster_index ? &cell_it->second : nullptr;
+    }
+
+    /**
+     * the overlay rows are kept symmetric, a writer of cell (cluster_index, i) writes it to i's overlay row as well
+     * (in case i has one)
+     * @param cluster_index - a cluster index
+     * @return the given cluster's overlay row, it is created from the cluster's current cells on first use
+     */
+    std::vector<AlgorithmDSManager::DissimilarityCell>& getOverlayRow(const int cluster_index);
+
+    /**
+     * the same as getOverlayRow in case only the candidate cells are kept, the overlay row holds the cells of the
+     * active clusters which are a candidate pair with the cluster only
+     * @param cluster_index - a cluster index
+     * @return the given cluster's candidate overlay row, it is created from the cluster's current cells on first use
+     */
+    CandidateCells& getCandidateOverlayRow(const int cluster_index);
+
+    /**
+     * @return the index of an overlay row which is not in use (in overlay_rows or in candidate_overlay_rows)
+     */
+    int allocateOverlayRow();
+
+    /**
+     * @return num of overlay rows (in use or not)
+     */
+    int getNumberOfOverlayRows() const{
+        return useCandidateCells() ? candidate_overlay_rows.size() : overlay_rows.size();
+    }
+
+    /**
+     * deactivate the given cluster in the workspace's dissimilarities matrix
+     * @param cluster_index - a cluster index
+     */
+    void deactivateClusterInDissimilarityMat(const int cluster_index);
+
+    /**
+     * adds the given cluster to the active clusters (does nothing in case it is already active)
+     * @param cluster_index - a cluster index
+     */
+    void addActiveCluster(const int cluster_index);
+
+    /**
+     * removes the given cluster from the active clusters by moving the last active cluster to its position (does
+     * nothing in case it is not active)
+     * @param cluster_index - a cluster index
+     */
+    void removeActiveCluster(const int cluster_index);
+
+    /**
+     * adds the given cluster to the modified clusters log (once per execution)
+     * @param cluster_index - a cluster index
+     */
+    void markClusterModified(const int cluster_index);
+
+    /**
+     * returns the given cluster's overlay row (if any) to the free overlay rows
+     * @param cluster_index - a cluster index
+     */
+    void releaseOverlayRow(const int cluster_index);
+
+    /**
+     * saves the current clustering state to checkpoint, only the modified clusters are copied
+     * @param checkpoint_random_generator - the random generator state to resume with
+     * @param num_current_clusters - the current num of clusters
+     */
+    void saveCheckpoint(const RandomGenerator& checkpoint_random_generator, const int num_current_clusters);
+
+    /**
+     * restores the clustering state saved in checkpoint, the clusters modified since it was saved are restored to
+     * their initial state first
+     */
+    void restoreCheckpoint();
+
+    /**
+     * the clustering state of an execution at the beginning of a merge, only the modified clusters' state is held
+     * since the rest of the clusters are in their initial state. the nodes are never modified, so copies of a
+     * checkpoint share them
+     */
+    struct Checkpoint final{
+        bool is_valid = false;
+        int num_current_clusters = 0;
+        double current_system_size = 0;
+        RandomGenerator random_generator;
+        std::vector<int> modified_clusters;
+        std::vector<std::shared_ptr<const Node>> modified_clusters_nodes;
+        std::vector<OriginClustersSizes> modified_clusters_size_from_origin_clusters;
+        BitMatrix modified_clusters_blocks;
+        std::vector<int> overlay_rows_indices;
+        std::vector<std::vector<AlgorithmDSManager::DissimilarityCell>> overlay_rows;
+        std::vector<CandidateCells> candidate_overlay_rows;
+        int num_overlay_rows = 0;
+        std::vector<int> cluster_overlay_row;
+        std::vector<int> free_overlay_rows;
+        std::set<std::pair<double, int>, std::greater<std::pair<double, int>>> active_clusters_sizes;
+        std::vector<int> active_clusters;
+        std::vector<int> active_cluster_position;
+        std::vector<std::vector<ClustersMergeOffer>> row_merge_offers;
+        std::vector<bool> is_row_merge_offers_complete;
+        std::vector<std::pair<int, int>> merges;
+    };
+
+    // current_system_size - the system size of the current clustering
+    // clusters - list of nodes which represent the cluster. each cluster contains set of all the files in it
+    // active_clusters_sizes - (size, cluster index) of every active cluster, in descending order
+    // active_clusters - compact list of the active clusters' indices (in no particular order), every scan over the
+    //                   clusters iterates it so merged and removed clusters are skipped without being visited
+    // active_cluster_position - per cluster, its position in active_clusters or NOT_ACTIVE_CLUSTER
+    // initial_system_size - the system size before the first merge
+    // ds - the DS manager whose (read only) dissimilarities matrix is the base of the workspace's matrix
+    // super_nodes - in case of a two level clustering, the super nodes whose (read only) dissimilarities matrix is the
+    //               base of the workspace's matrix instead of ds's, null otherwise
+    // use_exact_dissimilarities - whether ds's exact dissimilarities are the base of the workspace's matrix (see
+    //                             AlgorithmDSManager::getExactDissimilarityCell)
+    // ds_version - the version of ds the workspace was initialized with
+    // cluster_overlay_row - per cluster, index of its row in overlay_rows, NO_OVERLAY_ROW if its cells are ds's cells
+    //                       or DEACTIVATED_CLUSTER if it was deactivated (merged to another cluster or removed)
+    // overlay_rows - rows of all the cells of clusters which absorbed other clusters (a row per cluster)
+    // candidate_overlay_rows - used instead of overlay_rows in case only the candidate cells are kept, rows of the
+    //                          candidate cells of clusters which absorbed other clusters (a row per cluster). a merged
+    //                          cluster is a candidate pair with the clusters which were candidates of both its clusters
+    // merge_neighbours - the active clusters which were a candidate pair with any of the clusters of the last merge
+    //                    (relevant only in case only the candidate cells are kept)
+    // free_overlay_rows - indices of the overlay rows which are not in use
+    // is_cluster_modified - per cluster, whether it is in modified_clusters
+    // modified_clusters - undo log, the clusters which were modified since the last reset
+    // size_from_origin_clusters - per cluster, the size it holds from every origin cluster
+    // cluster_blocks - per cluster, the set of blocks of its files (row i is cluster i, column j is fingerprint j)
+    // random_generator - the random generator of the current run, seeded with the run's seed
+    // row_merge_offers - per row i of the dissimilarities matrix, the best merge offers (i, j<i) in ascending order
+    // is_row_merge_offers_complete - per row i, whether row_merge_offers[i] holds all the merge offers of the row
+    // merges - the (cluster1, cluster2) merges since the last reset, in order (cluster2 was merged into cluster1)
+    // checkpoint - the state to resume a failed execution from (at its first merge which the load balance constraint
+    //              restricted), the overlay rows and the modified clusters' state are held by their index in the
+    //              workspace (modified_clusters_blocks's row i is the blocks of modified_clusters[i])
+    // speculative_workspaces - workspaces of the margins tried concurrently by the retries of this workspace's
+    //                          clustering (a workspace per margin)
+    // exact_workspace - workspace of the exact clusterings which validate this workspace's clusterings, null until the
+    //                   first validation (see validateDissimilaritiesPrecision)
+public:
+    double current_system_size;
+    std::vector<std::unique_ptr<Node>> clusters;
+    std::set<std::pair<double, int>, std::greater<std::pair<double, int>>> active_clusters_sizes;
+    std::vector<int> active_clusters;
+    std::vector<int> active_cluster_position;
+    double initial_system_size;
+    const AlgorithmDSManager* ds;
+    const SuperNodes* super_nodes;
+    bool use_exact_dissimilarities;
+    int ds_version;
+    std::vector<int> cluster_overlay_row;
+    std::vector<std::vector<AlgorithmDSManager::DissimilarityCell>> overlay_rows;
+    std::vector<CandidateCells> candidate_overlay_rows;
+    std::vector<int> merge_neighbours;
+    std::vector<int> free_overlay_rows;
+    std::vector<bool> is_cluster_modified;
+    std::vector<int> modified_clusters;
+    std::vector<OriginClustersSizes> size_from_origin_clusters;
+    BitMatrix cluster_blocks;
+    RandomGenerator random_generator;
+    std::vector<std::vector<ClustersMergeOffer>> row_merge_offers;
+    std::vector<bool> is_row_merge_offers_complete;
+    std::vector<std::pair<int, int>> merges;
+    Checkpoint checkpoint;
+    std::vector<std::unique_ptr<ClusteringWorkspace>> speculative_workspaces;
+    std::unique_ptr<ClusteringWorkspace> exact_workspace;
+};
+
 struct HierarchicalClustering::ClusteringResult final{
 public:
     ClusteringResult(ClusteringParams clustering_params,
@@ -444,4 +1206,6 @@ public:
     const shared_ptr<map<string, set<int>>> clustering_final_mapping;
     shared_ptr<map<string, set<int>>> clustering_initial_mapping;
     shared_ptr<Calculator::CostResult> cost_result;
+    // the clustering's merges in order, nullptr for a result without clustering (like the "do nothing" program)
+    shared_ptr<const vector<pair<int, int>>> dendrogram;
 };
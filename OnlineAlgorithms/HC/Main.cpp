@@ -92,6 +92,74 @@ static void setUpAndValidateParser(CommandLineParser& parser){
                          "split transfer sort order, default is hard_deletion. options are hard_deletion, soft_deletion,"
                          " hard_lb and soft_lb. hard_lb is the option used for Slide and Balance split");
 
+    parser.addConstraint("-threads", CommandLineParser::ArgumentType::INT, 1, true,
+                         "num of worker threads for building the dissimilarities matrix and for the W_T x seed x gap sweep "
+                         "(optional, default is 1)");
+
+    parser.addConstraint("-lsh_bands", CommandLineParser::ArgumentType::INT, 1, true,
+                         "approximate mode - num of MinHash LSH bands. only the distances of LSH candidate pairs are "
+                         "calculated and kept, other pairs are taken as pairs without shared blocks (optional, default is "
+                         "the exact mode)");
+
+    parser.addConstraint("-lsh_rows", CommandLineParser::ArgumentType::INT, 1, true,
+                         "num of min hashes in every LSH band, relevant only with -lsh_bands (optional, default is 4)");
+
+    parser.addConstraint("-snapshot_dir", CommandLineParser::ArgumentType::STRING, 1, true,
+                         "directory of the ingestion snapshots. the state built by reading the workloads is loaded from "
+                         "its snapshot when the workloads, -fps and the snapshot's version match, and is saved otherwise "
+                         "(optional, default is to always read the workloads)");
+
+    parser.addConstraint("-resume_failed_clusterings", CommandLineParser::ArgumentType::BOOL, 0, true,
+                         "retry a load balanced clustering which fails to hold its margin from the first merge the "
+                         "margin restricted instead of from single files. every retry starts from the failed attempt's "
+                         "random state there, so the results differ from the default retries (optional, default false)");
+
+    parser.addConstraint("-speculative_margins", CommandLineParser::ArgumentType::INT, 1, true,
+                         "num of margins tried concurrently once a load balanced clustering fails to hold its margin, "
+                         "the results are the same as trying them one after another. every sweep thread uses that many "
+                         "threads for its retries, relevant only with -resume_failed_clusterings (optional, default is "
+                         "1)");
+
+    parser.addConstraint("-warm_start", CommandLineParser::ArgumentType::INT, 1, true,
+                         "% of the previous clustering's merges every clustering starts with. the merges of clusters "
+                         "without files removed since are taken as they are, only the rest is clustered again, "
+                         "can not be used with -lb (optional, default is clustering from single files)");
+
+    parser.addConstraint("-super_nodes", CommandLineParser::ArgumentType::STRING, 1, true,
+                         "two level clustering - 'host' to collapse the files of every host into a super node, or a "
+                         "jaccard distance below 1 to collapse every file into the first super node whose first file is "
+                         "within that distance from it (the first files are found through MinHash LSH buckets, so a file "
+                         "may rarely miss its super node). the super nodes are clustered instead of the files, so only "
+                         "their dissimilarities are calculated (optional, default is clustering the files)");
+
+    parser.addConstraint("-refine_super_nodes", CommandLineParser::ArgumentType::BOOL, 0, true,
+                         "once the super nodes are clustered, move every file which shares more blocks with another "
+                         "cluster than with its own cluster to that cluster, relevant only with -super_nodes and "
+                         "without -lb (optional, default false)");
+
+    parser.addConstraint("-dissimilarities_matrix_dir", CommandLineParser::ArgumentType::STRING, 1, true,
+                         "directory of a memory mapped file which keeps the files' dissimilarities matrix, so only the "
+                         "rows in use are kept in memory. the file is removed once the run ends (optional, default is "
+                         "keeping the matrix in memory)");
+
+    parser.addConstraint("-dissimilarities_precision", CommandLineParser::ArgumentType::STRING, 1, true,
+                         "precision of the dissimilarities matrix's distances - float32 (exact) or uint16 (quantized to "
+                         "1/65534 steps, half the size) (optional, default is float32)");
+
+    parser.addConstraint("-validate_dissimilarities_precision", CommandLineParser::ArgumentType::BOOL, 0, true,
+                         "run every clustering again on an exact copy of the dissimilarities matrix and report whether "
+                         "it chose other merges or another cost, relevant only with -dissimilarities_precision uint16 "
+                         "(optional, default false)");
+
+    parser.addConstraint("-sweep_budget", CommandLineParser::ArgumentType::INT, 1, true,
+                         "% of every sweep's clusterings which are fully evaluated. every clustering's cost is estimated "
+                         "from the clustering fingerprints, and only the ones with the best estimated costs are "
+                         "arranged and costed (optional, default is 100, evaluating all of them)");
+
+    parser.addConstraint("-validate_sweep_budget", CommandLineParser::ArgumentType::BOOL, 0, true,
+                         "fully evaluate the dropped clusterings as well and report whether the best result of the "
+                         "full sweep was evaluated, relevant only with -sweep_budget (optional, default false)");
+
     try {
         parser.validateConstraintsHold();
     }catch (const exception& e){
@@ -185,6 +253,167 @@ static int validateAndGetNumRuns(const CommandLineParser& parser){
     return stoi(current_arg.front());
 }
 
+static int validateAndGetNumThreads(const CommandLineParser& parser){
+    static constexpr int DEFAULT_NUM_THREADS = 1;
+    if(!parser.isTagExist("-threads"))
+        return DEFAULT_NUM_THREADS;
+
+    const int num_threads = stoi(parser.getTag("-threads").front());
+    if(num_threads < 1)
+        throw invalid_argument("num of threads should be at least 1");
+
+    return num_threads;
+}
+
+static int validateAndGetNumSpeculativeMargins(const CommandLineParser& parser){
+    static constexpr int DEFAULT_NUM_SPECULATIVE_MARGINS = 1;
+    if(!parser.isTagExist("-speculative_margins"))
+        return DEFAULT_NUM_SPECULATIVE_MARGINS;
+
+    if(!parser.isTagExist("-resume_failed_clusterings"))
+        throw invalid_argument("-speculative_margins is relevant only with -resume_failed_clusterings");
+
+    const int num_speculative_margins = stoi(parser.getTag("-speculative_margins").front());
+    if(num_speculative_margins < 1)
+        throw invalid_argument("num of speculative margins should be at least 1");
+
+    return num_speculative_margins;
+}
+
+static int validateAndGetWarmStartPercent(const CommandLineParser& parser){
+    if(!parser.isTagExist("-warm_start"))
+        return HierarchicalClustering::NO_WARM_START;
+
+    // the previous clustering's merges steer the clustering away from the load balance constraint, and every retry
+    // starts from them again
+    if(parser.isTagExist("-lb"))
+        throw invalid_argument("-warm_start can not be used with -lb");
+
+    const int warm_start_percent = stoi(parser.getTag("-warm_start").front());
+    if(warm_start_percent < 1 || warm_start_percent > 100)
+        throw invalid_argument("warm start percent should be between 1 and 100");
+
+    return warm_start_percent;
+}
+
+static double validateAndGetSuperNodesJaccardThreshold(const CommandLineParser& parser){
+    if(!parser.isTagExist("-super_nodes")){
+        if(parser.isTagExist("-refine_super_nodes"))
+            throw invalid_argument("-refine_super_nodes is relevant only with -super_nodes");
+
+        return SuperNodes::BY_HOST;
+    }
+
+    // the refinement moves files regardless of the clusters' load balance
+    if(parser.isTagExist("-refine_super_nodes") && parser.isTagExist("-lb"))
+        throw invalid_argument("-refine_super_nodes can not be used with -lb");
+
+    if(parser.isTagExist("-lsh_bands") || parser.isTagExist("-warm_start"))
+        throw invalid_argument("-super_nodes can not be used with -lsh_bands or -warm_start");
+
+    const string super_nodes = parser.getTag("-super_nodes").front();
+    if(super_nodes == "host")
+        return SuperNodes::BY_HOST;
+
+    const double jaccard_threshold = stod(super_nodes);
+    // a threshold of 1 collapses all the files into a single super node
+    if(jaccard_threshold < 0 || jaccard_threshold >= 1)
+        throw invalid_argument("super nodes jaccard threshold should be 'host' or at least 0 and below 1");
+
+    return jaccard_threshold;
+}
+
+static int validateAndGetLshNumBands(const CommandLineParser& parser){
+    static constexpr int EXACT_MODE_NUM_BANDS = 0;
+    if(!parser.isTagExist("-lsh_bands")){
+        if(parser.isTagExist("-lsh_rows"))
+            throw invalid_argument("-lsh_rows is relevant only with -lsh_bands");
+
+        return EXACT_MODE_NUM_BANDS;
+    }
+
+    const int num_bands = stoi(parser.getTag("-lsh_bands").front());
+    if(num_bands < 1)
+        throw invalid_argument("num of LSH bands should be at least 1");
+
+    return num_bands;
+}
+
+static int validateAndGetLshRowsPerBand(const CommandLineParser& parser){
+    static constexpr int DEFAULT_ROWS_PER_BAND = 4;
+    if(!parser.isTagExist("-lsh_rows"))
+        return DEFAULT_ROWS_PER_BAND;
+
+    const int rows_per_band = stoi(parser.getTag("-lsh_rows").front());
+    if(rows_per_band < 1)
+        throw invalid_argument("num of LSH rows per band should be at least 1");
+
+    return rows_per_band;
+}
+
+static std::string validateAndGetSnapshotDir(const CommandLineParser& parser){
+    static const std::string NO_SNAPSHOT_DIR = "";
+    if(!parser.isTagExist("-snapshot_dir"))
+        return NO_SNAPSHOT_DIR;
+
+    std::string snapshot_dir = parser.getTag("-snapshot_dir").front();
+    if(snapshot_dir.empty())
+        throw invalid_argument("snapshot dir should not be empty");
+
+    Utility::createDir(snapshot_dir);
+    return snapshot_dir;
+}
+
+static std::string validateAndGetDissimilaritiesMatrixDir(const CommandLineParser& parser){
+    if(!parser.isTagExist("-dissimilarities_matrix_dir"))
+        return DissimilaritiesMatrix::IN_MEMORY;
+
+    if(parser.isTagExist("-lsh_bands") || parser.isTagExist("-super_nodes"))
+        throw invalid_argument("-dissimilarities_matrix_dir can not be used with -lsh_bands or -super_nodes");
+
+    std::string dissimilarities_matrix_dir = parser.getTag("-dissimilarities_matrix_dir").front();
+    if(dissimilarities_matrix_dir.empty())
+        throw invalid_argument("dissimilarities matrix dir should not be empty");
+
+    Utility::createDir(dissimilarities_matrix_dir);
+    return dissimilarities_matrix_dir;
+}
+
+static DissimilaritiesMatrix::Precision validateAndGetDissimilaritiesPrecision(const CommandLineParser& parser){
+    if(!parser.isTagExist("-dissimilarities_precision")){
+        if(parser.isTagExist("-validate_dissimilarities_precision"))
+            throw invalid_argument("-validate_dissimilarities_precision is relevant only with -dissimilarities_precision "
+                                   "uint16");
+
+        return DissimilaritiesMatrix::Precision::FLOAT32;
+    }
+
+    if(parser.isTagExist("-lsh_bands") || parser.isTagExist("-super_nodes"))
+        throw invalid_argument("-dissimilarities_precision can not be used with -lsh_bands or -super_nodes");
+
+    const DissimilaritiesMatrix::Precision precision =
+            DissimilaritiesMatrix::getPrecision(parser.getTag("-dissimilarities_precision").front());
+    if(precision != DissimilaritiesMatrix::Precision::UINT16 && parser.isTagExist("-validate_dissimilarities_precision"))
+        throw invalid_argument("-validate_dissimilarities_precision is relevant only with -dissimilarities_precision "
+                               "uint16");
+
+    return precision;
+}
+
+static int validateAndGetSweepBudgetPercent(const CommandLineParser& parser){
+    if(!parser.isTagExist("-sweep_budget")){
+        if(parser.isTagExist("-validate_sweep_budget"))
+            throw invalid_argument("-validate_sweep_budget is relevant only with -sweep_budget");
+
+        return HierarchicalClustering::FULL_SWEEP_BUDGET;
+    }
+
+    const int sweep_budget_percent = stoi(parser.getTag("-sweep_budget").front());
+    if(sweep_budget_percent < 1 || sweep_budget_percent > HierarchicalClustering::FULL_SWEEP_BUDGET)
+        throw invalid_argument("sweep budget percent should be between 1 and 100");
+
+    return sweep_budget_percent;
+}
 
 static std::string validateAndGetFilesIndexFile(const CommandLineParser& parser){
     static const std::string DEFAULT_INDEX_PATH = "<a default path to files index in a json format>";
@@ -432,6 +661,46 @@ static string validateAndGetOutputPath(const CommandLineParser& parser){
  * 14. -result_sort_order: "sort order for the best result. use the following literals:
  *                          (traffic_valid, lb_valid, deletion, lb_score, traffic). The default sort order is
  *                          'traffic_valid lb_valid deletion lb_score traffic'"
+ * 15. -threads: num of worker threads for building the dissimilarities matrix and for the W_T x seed x gap sweep
+ *                (optional, default is 1)
+ * 16. -lsh_bands: approximate mode - num of MinHash LSH bands. only the distances of LSH candidate pairs are calculated
+ *                 and kept, other pairs are taken as pairs without shared blocks (optional, default is the exact mode)
+ * 17. -lsh_rows: num of min hashes in every LSH band, relevant only with -lsh_bands (optional, default is 4)
+ * 18. -snapshot_dir: directory of the ingestion snapshots. the state built by reading the workloads is loaded from its
+ *                    snapshot when the workloads, -fps and the snapshot's version match, and is saved otherwise
+ *                    (optional, default is to always read the workloads)
+ * 19. -resume_failed_clusterings: retry a load balanced clustering which fails to hold its margin from the first
+ *                                 merge the margin restricted instead of from single files. every retry starts from
+ *                                 the failed attempt's random state there, so the results differ from the default
+ *                                 retries (optional, default false)
+ * 20. -speculative_margins: num of margins tried concurrently once a load balanced clustering fails to hold its margin,
+ *                           the results are the same as trying them one after another. every sweep thread uses that
+ *                           many threads for its retries, relevant only with -resume_failed_clusterings (optional,
+ *                           default is 1)
+ * 21. -warm_start: % of the previous clustering's merges every clustering starts with. the merges of clusters without
+ *                  files removed since are taken as they are, only the rest is clustered again, can not be used
+ *                  with -lb (optional, default is clustering from single files)
+ * 22. -super_nodes: two level clustering - 'host' to collapse the files of every host into a super node, or a jaccard
+ *                   distance below 1 to collapse every file into the first super node whose first file is within that
+ *                   distance from it (the first files are found through MinHash LSH buckets, so a file may rarely miss
+ *                   its super node). the super nodes are clustered instead of the files, so only their dissimilarities
+ *                   are calculated (optional, default is clustering the files)
+ * 23. -refine_super_nodes: once the super nodes are clustered, move every file which shares more blocks with another
+ *                          cluster than with its own cluster to that cluster, relevant only with -super_nodes and
+ *                          without -lb (optional, default false)
+ * 24. -dissimilarities_matrix_dir: directory of a memory mapped file which keeps the files' dissimilarities matrix, so
+ *                                  only the rows in use are kept in memory. the file is removed once the run ends
+ *                                  (optional, default is keeping the matrix in memory)
+ * 25. -dissimilarities_precision: precision of the dissimilarities matrix's distances - float32 (exact) or uint16
+ *                                 (quantized to 1/65534 steps, half the size) (optional, default is float32)
+ * 26. -validate_dissimilarities_precision: run every clustering again on an exact copy of the dissimilarities matrix
+ *                                          and report whether it chose other merges or another cost, relevant only
+ *                                          with -dissimilarities_precision uint16 (optional, default false)
+ * 27. -sweep_budget: % of every sweep's clusterings which are fully evaluated. every clustering's cost is estimated
+ *                    from the clustering fingerprints, and only the ones with the best estimated costs are arranged
+ *                    and costed (optional, default is 100, evaluating all of them)
+ * 28. -validate_sweep_budget: fully evaluate the dropped clusterings as well and report whether the best result of the
+ *                             full sweep was evaluated, relevant only with -sweep_budget (optional, default false)
  */
 int main(int argc, char **argv) {
     try {
@@ -466,16 +735,35 @@ int main(int argc, char **argv) {
         const bool is_converge_margin = parser.isTagExist("-converge_margin");
         const bool use_new_dist_metric = parser.isTagExist("-use_new_dist_metric");
         const bool carry_traffic = parser.isTagExist("-carry_traffic");
+        const int num_threads = validateAndGetNumThreads(parser);
+        const int lsh_num_bands = validateAndGetLshNumBands(parser);
+        const int lsh_rows_per_band = validateAndGetLshRowsPerBand(parser);
+        const std::string snapshot_dir = validateAndGetSnapshotDir(parser);
+        const bool resume_failed_clusterings = parser.isTagExist("-resume_failed_clusterings");
+        const int num_speculative_margins = validateAndGetNumSpeculativeMargins(parser);
+        const int warm_start_percent = validateAndGetWarmStartPercent(parser);
+        const bool use_super_nodes = parser.isTagExist("-super_nodes");
+        const double super_nodes_jaccard_threshold = validateAndGetSuperNodesJaccardThreshold(parser);
+        const bool refine_super_nodes = parser.isTagExist("-refine_super_nodes");
+        const std::string dissimilarities_matrix_dir = validateAndGetDissimilaritiesMatrixDir(parser);
+        const DissimilaritiesMatrix::Precision dissimilarities_precision = validateAndGetDissimilaritiesPrecision(parser);
+        const bool validate_dissimilarities_precision = parser.isTagExist("-validate_dissimilarities_precision");
+        const int sweep_budget_percent = validateAndGetSweepBudgetPercent(parser);
+        const bool validate_sweep_budget = parser.isTagExist("-validate_sweep_budget");
 
         validateAndFillSortOrder(parser);
 
         //init matrices
         unique_ptr<AlgorithmDSManager> DSManager = make_unique<AlgorithmDSManager>(
                 workloads_paths, requested_number_of_fingerprints, num_changes_iterations, change_seed, changes_perc,
-                changes_input_file, files_index_path, load_balance, change_type, num_runs);
+                changes_input_file, files_index_path, load_balance, change_type, num_runs, false, num_threads,
+                lsh_num_bands, lsh_rows_per_band, snapshot_dir, !use_super_nodes,
+                dissimilarities_matrix_dir, dissimilarities_precision, validate_dissimilarities_precision);
 
         //run HC
-        HierarchicalClustering HC(DSManager, lb_sizes);
+        HierarchicalClustering HC(DSManager, lb_sizes, num_threads, resume_failed_clusterings, num_speculative_margins,
+                                  warm_start_percent, use_super_nodes, super_nodes_jaccard_threshold, refine_super_nodes,
+                                  validate_dissimilarities_precision, sweep_budget_percent, validate_sweep_budget);
         HC.run(workloads_paths, change_pos, num_changes_iterations, load_balance, use_cache, cache_path, margin, eps,
                traffic, wts, seeds, gaps, num_iterations, output_path_prefix, num_runs,
                is_converge_margin, use_new_dist_metric, split_sort_order, carry_traffic);
@@ -5,7 +5,16 @@ Node::Node(const int file, const double size) :
     m_is_activated(true),
     m_size(size),
     m_orig_size(size),
-    m_orig_file(file)
+    m_orig_files({file})
+{
+}
+
+Node::Node(const std::set<int>& files, const double size) :
+    m_current_files(files),
+    m_is_activated(true),
+    m_size(size),
+    m_orig_size(size),
+    m_orig_files(files)
 {
 }
 
@@ -34,7 +43,7 @@ double Node::getSize() const{
 }
 
 void Node::reset() {
-    m_current_files = {m_orig_file};
+    m_current_files = m_orig_files;
     m_size = m_orig_size;
     m_is_activated = true;
 }
@@ -12,6 +12,13 @@ public:
      */
     explicit Node(const int file,  const double size);
 
+    /**
+     * creates an initial node of a group of files (a super node)
+     * @param files - the files
+     * @param size - the size of the given files' blocks
+     */
+    explicit Node(const std::set<int>& files, const double size);
+
     /**
      * the next 8 functions are getters/setters
      */
@@ -31,13 +38,13 @@ public:
 
 //m_size - cluster size in bytes
 //m_orig_size - used for resetting node to its orig state
-//m_orig_file - used for resetting node to its orig state
+//m_orig_files - used for resetting node to its orig state
 //m_is_activated - is this not is activated
 //m_current_files - set of all file currently in cluster
 private:
     double m_size;
     const double m_orig_size;
-    const int m_orig_file;
+    const std::set<int> m_orig_files;
     bool m_is_activated;
     std::set<int> m_current_files;
 };
@@ -1,15 +1,25 @@
 #include "AlgorithmDSManager.hpp"
+#include "MappedFile.hpp"
 
 #include <iostream>
 #include <algorithm>
 #include <utility>
 #include <cfloat>
+#include <cstring>
 #include <math.h>
 #include <sstream>
 #include <string>
 #include <istream>
+#include <chrono>
+#include <atomic>
+#include <mutex>
 #include "json.hpp"
 
+const AlgorithmDSManager::DissimilarityCell AlgorithmDSManager::NON_CANDIDATE_CELL(1);
+constexpr int AlgorithmDSManager::NO_FILE_INDEX;
+constexpr int AlgorithmDSManager::NO_HOST;
+constexpr int AlgorithmDSManager::NOT_SELECTED_FINGERPRINT;
+
 AlgorithmDSManager::AlgorithmDSManager(
         const std::vector<std::string>& workloads_paths,
         const int requested_number_of_fingerprints,
@@ -21,7 +31,23 @@ AlgorithmDSManager::AlgorithmDSManager(
         const bool load_balance,
         const ChangeType change_type,
         const int num_runs,
-        const bool is_only_appearances_mat) :
+        const bool is_only_appearances_mat,
+        const int num_threads,
+        const int lsh_num_bands,
+        const int lsh_rows_per_band,
+        const std::string& snapshot_dir,
+        const bool is_dissimilarities_matrix_needed,
+        const std::string& dissimilarities_matrix_dir,
+        const DissimilaritiesMatrix::Precision dissimilarities_precision,
+        const bool keep_exact_dissimilarities) :
+        m_num_threads(std::max(num_threads, 1)),
+        m_is_dissimilarities_matrix_needed(is_dissimilarities_matrix_needed),
+        m_minhash_lsh(lsh_num_bands > 0 ? std::make_unique<MinHashLsh>(lsh_num_bands, lsh_rows_per_band) : nullptr),
+        m_dissimilarities_matrix(DissimilaritiesMatrix::create(dissimilarities_matrix_dir, dissimilarities_precision)),
+        m_exact_dissimilarities_matrix(
+                keep_exact_dissimilarities && dissimilarities_precision != DissimilaritiesMatrix::Precision::FLOAT32 ?
+                DissimilaritiesMatrix::create(DissimilaritiesMatrix::IN_MEMORY, DissimilaritiesMatrix::Precision::FLOAT32) :
+                nullptr),
         m_requested_number_of_fingerprints(requested_number_of_fingerprints),
         m_workloads_paths(getWorkloadsFullPaths(workloads_paths)),
         m_number_of_files_for_clustering(0),
@@ -30,16 +56,29 @@ AlgorithmDSManager::AlgorithmDSManager(
         m_optimal_system_size_with_deduplication(0),
         m_host_name(Utility::getHostName()),
         m_change_input_file_path(Utility::getFullPath(changes_input_file)),
-        m_max_file_sn(0)
+        m_max_file_sn(0),
+        m_system_size_with_deduplication(0),
+        m_version(0)
         {
-            const std::vector<int> fingerprints_for_clustering_ordered_by_SN = initializeAndSelectFingerprints();
-            initializeAppearancesMatrix(fingerprints_for_clustering_ordered_by_SN, load_balance, is_only_appearances_mat);
+            if(m_workloads_paths.size() > OriginClustersSizes::MAX_ORIGIN_CLUSTERS)
+                throw std::invalid_argument("at most " + std::to_string(OriginClustersSizes::MAX_ORIGIN_CLUSTERS) +
+                                            " workloads are supported");
+
+            if(!loadIngestionSnapshot(snapshot_dir, is_only_appearances_mat))
+            {
+                WorkloadsFilesRecipes files_recipes;
+                const std::vector<int> fingerprints_for_clustering_ordered_by_SN = initializeAndSelectFingerprints(files_recipes);
+                initializeAppearancesMatrix(files_recipes, fingerprints_for_clustering_ordered_by_SN, load_balance,
+                                            is_only_appearances_mat);
+                saveIngestionSnapshot(snapshot_dir, is_only_appearances_mat);
+            }
             initializeChangesList(changes_input_file, change_seed,
                                   num_changes_iterations, changes_perc, change_type, num_runs);
             initFileIndexInfo(index_path);
             if(!is_only_appearances_mat)
             {
-                initializeDissimilaritiesMatrix();
+                updateDissimilaritiesMatrix();
+                initializeFileSizeFromOriginClusters();
             }
         }
 
@@ -77,97 +116,84 @@ void AlgorithmDSManager::initFileIndexInfo(const std::string& path){
 
 }
 
-std::vector<std::ifstream> AlgorithmDSManager::getWorkloadsStreams() const{
+void AlgorithmDSManager::updateFPWithWorkloadBlockLine(CsvTokenizer& block_line, std::vector<bool>& current_blocks,
+                                                       FingerprintSampler& fingerprint_sampler){
+    const int block_sn = block_line.nextInt();
+    if (block_sn >= current_blocks.size())
+        current_blocks.resize(block_sn + 1, false);
 
-    std::vector<std::ifstream> workloads_ifstream;
-    //read files
-    for (int i = 0; i < m_workloads_paths.size(); ++i) {
-        workloads_ifstream.emplace_back(m_workloads_paths[i]);
-        if (!workloads_ifstream[i].is_open()) {
-            workloads_ifstream[i].close();
-            throw std::runtime_error("error opening workload with index " + std::to_string(i));
-        }
-    }
+    if (current_blocks[block_sn])//already used this fp
+        return;
+    current_blocks[block_sn] = true;
 
-    return std::move(workloads_ifstream);
+    const CsvTokenizer::Field block_fingerprint = block_line.nextField();
+    fingerprint_sampler.addFingerprint(block_sn, block_fingerprint.begin, block_fingerprint.end);
 }
 
-void AlgorithmDSManager::closeWorkloadsStreams(std::vector<std::ifstream>& workloads_streams){
-
-    //close all workloads' streams we opened before if still opened
-    for(auto& f : workloads_streams){
-        if (!f.is_open())
-            f.close();
+void AlgorithmDSManager::addWorkloadFileRecipe(CsvTokenizer& file_line, const int workload_index,
+                                               WorkloadsFilesRecipes& files_recipes){
+    // F, <file sn>, <volume>_<input file>, <dir>, <num of blocks>, <block sn>, <block size>, ...
+    // (the file sn was already read)
+    const CsvTokenizer::Field file_id = file_line.nextField();
+    file_line.skipFields(1);
+    const long long num_blocks = file_line.nextInt();
+
+    const char* const input_file_begin = static_cast<const char*>(std::memchr(file_id.begin, '_', file_id.size()));
+    if (input_file_begin == nullptr)
+        throw std::runtime_error("file id is not <volume>_<input file>: " + file_id.toString());
+    const char* input_file_end = static_cast<const char*>(std::memchr(input_file_begin + 1, '_',
+                                                                      file_id.end - input_file_begin - 1));
+    if (input_file_end == nullptr)
+        input_file_end = file_id.end;
+
+    files_recipes.workload_index.push_back(workload_index);
+    files_recipes.input_file.emplace_back(input_file_begin + 1, input_file_end);
+    for (long long i = 0; i < num_blocks; ++i) {
+        files_recipes.block_sns.push_back(file_line.nextInt());
+        files_recipes.block_sizes.push_back(file_line.nextInt());
     }
+    files_recipes.first_block_offset.push_back(files_recipes.block_sns.size());
 }
 
-void AlgorithmDSManager::updateFPWithWorkloadBlockLine(const std::vector<std::string>& splitted_line_content,
-                                                       std::unordered_set<int>& current_blocks,
-                                                       const int requested_num_fps,
-                                                       std::priority_queue<std::pair<std::string, int>>& minhash_fingerprints){
-    const int block_sn = Utility::getWorkloadBlockSN(splitted_line_content);
-    if (!current_blocks.insert(block_sn).second)//already used this fp
-        return;
+void AlgorithmDSManager::loadWorkload(const int workload_index, std::vector<bool>& current_blocks,
+                                      FingerprintSampler& fingerprint_sampler,
+                                      WorkloadsFilesRecipes& files_recipes){
+    static const std::string BLOCK_LINE_START_STRING = "B";
+    static const std::string FILE_LINE_START_STRING = "F";
 
-    const std::string& block_fingerprint = Utility::getWorkloadBlockFingerprint(splitted_line_content);
-    static const int NO_LIMIT = -1;
-
-    //if we yet to collect m_requested_number_of_fingerprints fps, or we need all the fps, add it
-    if (requested_num_fps == NO_LIMIT || minhash_fingerprints.size() < requested_num_fps){
-        minhash_fingerprints.push(std::make_pair(block_fingerprint, block_sn));
-        return;
-    }
-
-    //if fp is lexi prior to the max value we currently have, replace them
-    if (block_fingerprint < minhash_fingerprints.top().first) {
-        minhash_fingerprints.pop();
-        minhash_fingerprints.push(std::make_pair(block_fingerprint, block_sn));
-    }
-}
-
-void AlgorithmDSManager::updateFPWithWorkload(std::ifstream& workload_file, const int workload_index,
-                                              int& current_algo_file_index,std::unordered_set<int>& current_blocks,
-                                              const int requested_num_fps,
-                                              std::priority_queue<std::pair<std::string, int>>& minhash_fingerprints){
     const std::string& workload_path = getWorkloadFullPath(workload_index);
     m_initial_mapping[workload_path] = {};
-    std::string line_content;
-    while (std::getline(workload_file, line_content)) {
-        if(line_content.length() == 0){
-            continue;
-        }
-        const std::vector<std::string> splitted_line_content = Utility::splitString(line_content, ',');
-        if(Utility::isWorkloadBlockLine(splitted_line_content)){
-            updateFPWithWorkloadBlockLine(splitted_line_content, current_blocks, requested_num_fps, minhash_fingerprints);
+
+    const MappedFile workload_file(workload_path);
+    CsvTokenizer line(workload_file.begin(), workload_file.end());
+    while (line.nextLine()) {
+        const CsvTokenizer::Field line_type = line.nextField();
+        if (line_type == BLOCK_LINE_START_STRING){
+            updateFPWithWorkloadBlockLine(line, current_blocks, fingerprint_sampler);
         }
-        else if (Utility::isWorkloadFileLine(splitted_line_content)) {
+        else if (line_type == FILE_LINE_START_STRING) {
             //count files and match workload i and file m_number_of_files_for_clustering (algorithm's sn) to original file sn
-            m_initial_mapping.at(workload_path).insert(current_algo_file_index);
-            const int file_sn = Utility::getWorkloadFileSN(splitted_line_content);
-            m_file_sn_to_algo_index[file_sn] = current_algo_file_index;
+            m_initial_mapping.at(workload_path).insert(m_number_of_files_for_clustering);
+            const int file_sn = line.nextInt();
+            setFileSNIndex(file_sn, m_number_of_files_for_clustering);
             m_max_file_sn = std::max(m_max_file_sn, file_sn);
-            m_file_index_to_sn[current_algo_file_index++] = file_sn;
+            m_file_index_to_sn.push_back(file_sn);
+            m_number_of_files_for_clustering++;
+
+            addWorkloadFileRecipe(line, workload_index, files_recipes);
         }
     }
 }
 
-std::vector<int> AlgorithmDSManager::getFPForClusteringOrderedBySN(std::priority_queue<std::pair<std::string, int>>& minhash_fingerprints,
+std::vector<int> AlgorithmDSManager::getFPForClusteringOrderedBySN(const FingerprintSampler& fingerprint_sampler,
                                                                    std::map<std::string, int>& fp_to_index){
-    std::vector<int> fingerprints_for_clustering_ordered_by_SN;
-    fingerprints_for_clustering_ordered_by_SN.reserve(minhash_fingerprints.size());
+    const std::vector<std::pair<int, std::string>> selected_fingerprints = fingerprint_sampler.getSelectedOrderedBySN();
 
-    std::map<int, std::string> sn_to_fp = {};
-    while (!minhash_fingerprints.empty()){
-        sn_to_fp[minhash_fingerprints.top().second] = minhash_fingerprints.top().first;
-        fingerprints_for_clustering_ordered_by_SN.emplace_back(minhash_fingerprints.top().second);
-        minhash_fingerprints.pop();
-    }
-
-    //sort by SN
-    sort(fingerprints_for_clustering_ordered_by_SN.begin(), fingerprints_for_clustering_ordered_by_SN.end());
-
-    for(int i=0; i < fingerprints_for_clustering_ordered_by_SN.size(); ++i){
-        fp_to_index[sn_to_fp[fingerprints_for_clustering_ordered_by_SN[i]]] = i;
+    std::vector<int> fingerprints_for_clustering_ordered_by_SN;
+    fingerprints_for_clustering_ordered_by_SN.reserve(selected_fingerprints.size());
+    for(int i=0; i < selected_fingerprints.size(); ++i){
+        fingerprints_for_clustering_ordered_by_SN.emplace_back(selected_fingerprints[i].first);
+        fp_to_index[selected_fingerprints[i].second] = i;
     }
 
     return std::move(fingerprints_for_clustering_ordered_by_SN);
@@ -286,11 +312,11 @@ void AlgorithmDSManager::addFile(const std::string& file_path_to_add, const std:
             fileLine = content;
 
             m_max_file_sn++;
-            m_file_sn_to_algo_index[m_max_file_sn] = m_number_of_files_for_clustering;
-            m_file_index_to_sn[m_number_of_files_for_clustering] = m_max_file_sn;
-            m_file_index_to_input_file[m_number_of_files_for_clustering] = input_file_to_add;
+            setFileSNIndex(m_max_file_sn, m_number_of_files_for_clustering);
+            m_file_index_to_sn.push_back(m_max_file_sn);
+            m_file_index_to_input_file.push_back(input_file_to_add);
             m_input_file_to_file_index[input_file_to_add] = m_number_of_files_for_clustering;
-            m_file_to_size[m_number_of_files_for_clustering] = 0;
+            m_file_to_size.push_back(0);
 
             m_initial_mapping[m_workloads_paths[vol_index]].emplace(m_number_of_files_for_clustering);
             std::cout << "add " << input_file_to_add << " to volume:" << vol_index << std::endl;
@@ -304,7 +330,7 @@ void AlgorithmDSManager::addFile(const std::string& file_path_to_add, const std:
             if(m_fingerprint_to_index.find(blockFp) == m_fingerprint_to_index.cend()){
                 // new block
                 m_fingerprint_to_index[blockFp] = m_fingerprint_to_size.size();
-                m_fingerprint_to_size[m_fingerprint_to_size.size()] = 0;
+                m_fingerprint_to_size.push_back(0);
 
                 block_local_sn_to_index[blockLocalSn] = m_fingerprint_to_size.size();
 
@@ -329,7 +355,8 @@ void AlgorithmDSManager::addFile(const std::string& file_path_to_add, const std:
 
     //add blocks
     std::string file_num_blocks = Utility::getCommaToken(ss, true);
-    m_appearances_matrix.emplace_back(m_fingerprint_to_index.size(), false);
+    m_appearances_matrix.reserveColumns(m_fingerprint_to_index.size());
+    m_appearances_matrix.addRow();
 
     const uint64_t num_blocks = std::stoull(file_num_blocks);
     for(uint64_t i=0; i < num_blocks; ++i)
@@ -340,10 +367,10 @@ void AlgorithmDSManager::addFile(const std::string& file_path_to_add, const std:
         double block_size_double = std::stod(block_size);
         unsigned long block_size_long = static_cast<unsigned long>(block_size_double > 0 ? block_size_double: 4096.0); //should not happen. if it does we treat it as 4KB block
         const int fp_index = block_local_sn_to_index[std::stoull(block_sn)];
-        m_fingerprint_to_size[fp_index] = block_size_long;
+        setFingerprintSize(fp_index, block_size_long);
         m_file_to_size[m_number_of_files_for_clustering] += block_size_long;
 
-        m_appearances_matrix.back()[fp_index] = true;
+        m_appearances_matrix.set(m_number_of_files_for_clustering, fp_index);
     }
 
     m_number_of_files_for_clustering++;
@@ -396,6 +423,19 @@ int AlgorithmDSManager::getHostByPath(const std::string& path){
     return host_of_file;
 }
 
+std::vector<int> AlgorithmDSManager::getFilesHosts() const{
+    std::vector<int> files_hosts(m_number_of_files_for_clustering, NO_HOST);
+    for (const auto& host_files : m_host_to_file_ordered) {
+        for (const std::string& input_file : host_files.second) {
+            const auto file_index_it = m_input_file_to_file_index.find(input_file);
+            if (file_index_it != m_input_file_to_file_index.cend())
+                files_hosts[file_index_it->second] = host_files.first;
+        }
+    }
+
+    return files_hosts;
+}
+
 int AlgorithmDSManager::findFileAndGetVolIndex(const int file_index, const std::shared_ptr<std::map<std::string, std::set<int>>>& backup_hints) {
     if(backup_hints == nullptr)
     {
@@ -467,190 +507,431 @@ void AlgorithmDSManager::applyUpdatesIter(const int change_iter, const std::shar
     }
 
     // expand appearances matrix to have cells for the new blocks
-    for(int i=0; i < m_number_of_files_for_clustering; ++i){
-        for(int b=m_appearances_matrix[i].size(); b < m_number_of_fingerprints_for_clustering;++b){
-            m_appearances_matrix[i].emplace_back(false);
-        }
-    }
+    m_appearances_matrix.reserveColumns(m_number_of_fingerprints_for_clustering);
+    m_file_blocks_index.indexNewFiles(m_appearances_matrix);
+
+    // update m_initial_system_size_with_deduplication and m_optimal_system_size_with_deduplication with the changed
+    // files only
+    updateBlocksRefCounts();
 
-    // recalculate m_initial_system_size_with_deduplication and m_optimal_system_size_with_deduplication after new blocks
     m_initial_system_size_with_deduplication = 0;
-    m_optimal_system_size_with_deduplication = 0;
+    for(const long long int volume_size: m_volume_size_with_deduplication)
+        m_initial_system_size_with_deduplication += volume_size;
+    m_optimal_system_size_with_deduplication = m_system_size_with_deduplication;
 
-    std::unordered_set<int> optimal_volumes;
-    for(const auto& workload_files: m_initial_mapping){
-        std::unordered_set<int> current_volume;
-        for(const auto& file: workload_files.second){
-            for(int block_index = 0; block_index< m_number_of_fingerprints_for_clustering; ++block_index){
-                if(m_appearances_matrix[file][block_index]){
-                    if (current_volume.insert(block_index).second)
-                        m_initial_system_size_with_deduplication += m_fingerprint_to_size[block_index];
-
-                    if (optimal_volumes.insert(block_index).second)
-                        m_optimal_system_size_with_deduplication += m_fingerprint_to_size[block_index];
-                }
-            }
-        }
-    }
+    updateDissimilaritiesMatrix();
+    initializeFileSizeFromOriginClusters();
+    m_version++;
+}
+
+std::vector<int> AlgorithmDSManager::initializeAndSelectFingerprints(WorkloadsFilesRecipes& files_recipes) {
+    // current_blocks (block sn to whether it was seen) for not using same fp twice
+    std::vector<bool> current_blocks;
+    FingerprintSampler fingerprint_sampler(m_requested_number_of_fingerprints);
 
-    initializeDissimilaritiesMatrix();
+    for (int workload_index = 0; workload_index < m_workloads_paths.size(); ++workload_index)
+        loadWorkload(workload_index, current_blocks, fingerprint_sampler, files_recipes);
+
+    std::vector<int> fingerprints_for_clustering_ordered_by_SN = getFPForClusteringOrderedBySN(fingerprint_sampler,
+                                                                                               m_fingerprint_to_index);
+    m_number_of_fingerprints_for_clustering = fingerprints_for_clustering_ordered_by_SN.size();
+
+    return std::move(fingerprints_for_clustering_ordered_by_SN);
 }
 
-std::vector<int> AlgorithmDSManager::initializeAndSelectFingerprints() {
-    // current_blocks for not using same fp twice
-    std::unordered_set<int> current_blocks;
-    std::vector<std::ifstream> workloads_streams = getWorkloadsStreams();
-    std::priority_queue<std::pair<std::string, int>> minhash_fingerprints; // priority queue of fps' <fp, sn>
+IngestionSnapshot::Key AlgorithmDSManager::getIngestionSnapshotKey(const bool is_only_appearances_mat) const {
+    return {m_workloads_paths, m_requested_number_of_fingerprints, is_only_appearances_mat};
+}
 
-    for (int workload_index = 0; workload_index < workloads_streams.size(); ++workload_index) {
-        updateFPWithWorkload(workloads_streams[workload_index], workload_index, m_number_of_files_for_clustering,
-                             current_blocks, m_requested_number_of_fingerprints, minhash_fingerprints);
+bool AlgorithmDSManager::loadIngestionSnapshot(const std::string& snapshot_dir, const bool is_only_appearances_mat){
+    if(snapshot_dir.empty())
+        return false;
+
+    const IngestionSnapshot::Key key = getIngestionSnapshotKey(is_only_appearances_mat);
+    const std::string snapshot_path = IngestionSnapshot::getSnapshotPath(snapshot_dir, key);
+    IngestionSnapshot::Contents contents;
+    BitMatrix appearances_matrix;
+    if(!IngestionSnapshot::load(snapshot_path, key, contents, appearances_matrix)){
+        std::cout << "no valid ingestion snapshot at " << snapshot_path << ", reading the workloads" << std::endl;
+        return false;
     }
 
-    std::map<int, std::string> sn_to_fp = {};
+    m_number_of_files_for_clustering = appearances_matrix.getNumRows();
+    m_number_of_fingerprints_for_clustering = appearances_matrix.getNumColumns();
+    m_appearances_matrix = std::move(appearances_matrix);
+    m_file_blocks_index.clear();
+    m_file_blocks_index.indexNewFiles(m_appearances_matrix);
+
+    for(const std::string& workload_path : m_workloads_paths)
+        m_initial_mapping[workload_path] = {};
+
+    for(int file_index = 0; file_index < m_number_of_files_for_clustering; ++file_index){
+        m_initial_mapping.at(m_workloads_paths[contents.file_workload_index[file_index]]).insert(file_index);
+        const int file_sn = contents.file_index_to_sn[file_index];
+        setFileSNIndex(file_sn, file_index);
+        m_max_file_sn = std::max(m_max_file_sn, file_sn);
+        m_input_file_to_file_index[contents.file_index_to_input_file[file_index]] = file_index;
+    }
+    m_file_index_to_sn = std::move(contents.file_index_to_sn);
+    m_file_index_to_input_file = std::move(contents.file_index_to_input_file);
+    m_file_to_size = std::move(contents.file_to_size);
 
-    std::vector<int> fingerprints_for_clustering_ordered_by_SN = getFPForClusteringOrderedBySN(minhash_fingerprints,
-                                                                                               m_fingerprint_to_index);
-    m_number_of_fingerprints_for_clustering = fingerprints_for_clustering_ordered_by_SN.size();
+    for(int fingerprint_index = 0; fingerprint_index < m_number_of_fingerprints_for_clustering; ++fingerprint_index)
+        m_fingerprint_to_index[contents.fingerprints[fingerprint_index]] = fingerprint_index;
+    m_fingerprint_to_size = std::move(contents.fingerprint_to_size);
 
-    closeWorkloadsStreams(workloads_streams);
+    m_initial_system_size_with_deduplication = contents.initial_system_size_with_deduplication;
+    m_optimal_system_size_with_deduplication = contents.optimal_system_size_with_deduplication;
 
-    return std::move(fingerprints_for_clustering_ordered_by_SN);
+    std::cout << "loaded ingestion snapshot " << snapshot_path << std::endl;
+    return true;
+}
+
+void AlgorithmDSManager::saveIngestionSnapshot(const std::string& snapshot_dir, const bool is_only_appearances_mat) const{
+    if(snapshot_dir.empty())
+        return;
+
+    IngestionSnapshot::Contents contents;
+    contents.file_workload_index.resize(m_number_of_files_for_clustering);
+    for(int workload_index = 0; workload_index < m_workloads_paths.size(); ++workload_index){
+        for(const int file_index : m_initial_mapping.at(m_workloads_paths[workload_index]))
+            contents.file_workload_index[file_index] = workload_index;
+    }
+    contents.file_index_to_sn = m_file_index_to_sn;
+    contents.file_index_to_input_file = m_file_index_to_input_file;
+    contents.file_to_size = m_file_to_size;
+    contents.fingerprints.resize(m_number_of_fingerprints_for_clustering);
+    for(const auto& fingerprint_index : m_fingerprint_to_index)
+        contents.fingerprints[fingerprint_index.second] = fingerprint_index.first;
+    contents.fingerprint_to_size = m_fingerprint_to_size;
+    contents.initial_system_size_with_deduplication = m_initial_system_size_with_deduplication;
+    contents.optimal_system_size_with_deduplication = m_optimal_system_size_with_deduplication;
+
+    // the run goes on without a snapshot in case it could not be saved
+    const IngestionSnapshot::Key key = getIngestionSnapshotKey(is_only_appearances_mat);
+    const std::string snapshot_path = IngestionSnapshot::getSnapshotPath(snapshot_dir, key);
+    try {
+        IngestionSnapshot::save(snapshot_path, key, contents, m_appearances_matrix);
+        std::cout << "saved ingestion snapshot " << snapshot_path << std::endl;
+    } catch (const std::runtime_error& e) {
+        std::cerr << "could not save ingestion snapshot: " << e.what() << std::endl;
+    }
 }
 
 void AlgorithmDSManager::clearAppearancesMatrix(){
     //create the appearances_matrix with initial values false
-    m_appearances_matrix = std::vector<std::vector<bool>>();
-    m_appearances_matrix.reserve(m_number_of_files_for_clustering);
-    for (int i = 0; i < m_number_of_files_for_clustering; ++i)
-        m_appearances_matrix.emplace_back(m_number_of_fingerprints_for_clustering, false);
+    m_appearances_matrix = BitMatrix(m_number_of_files_for_clustering, m_number_of_fingerprints_for_clustering);
 }
 
-void AlgorithmDSManager::updateAppearancesMatWithWorkloadFileLine(
-        const std::vector<int>& fingerprints_for_clustering_ordered_by_SN,
-        const std::vector<std::string>& splitted_line_content,
+void AlgorithmDSManager::setFingerprintSize(const int fingerprint_index, const int size){
+    int& fingerprint_size = m_fingerprint_to_size[fingerprint_index];
+    const long long int size_diff = static_cast<long long int>(size) - fingerprint_size;
+    fingerprint_size = size;
+
+    if(fingerprint_index >= m_system_block_ref_count.size() || m_system_block_ref_count[fingerprint_index] == 0)
+        return;
+
+    m_system_size_with_deduplication += size_diff;
+    for(int volume_index = 0; volume_index < m_volume_block_ref_count.size(); ++volume_index){
+        if(m_volume_block_ref_count[volume_index][fingerprint_index] > 0)
+            m_volume_size_with_deduplication[volume_index] += size_diff;
+    }
+}
+
+void AlgorithmDSManager::updateBlocksRefCounts(){
+    static constexpr int NO_VOLUME = -1;
+
+    // grow the ref counts for new files, new volumes and new blocks
+    const int num_fingerprints = m_appearances_matrix.getNumColumns();
+    m_file_to_counted_volume.resize(m_number_of_files_for_clustering, NO_VOLUME);
+    m_volume_block_ref_count.resize(m_initial_mapping.size());
+    m_volume_size_with_deduplication.resize(m_initial_mapping.size(), 0);
+    for(auto& block_ref_count : m_volume_block_ref_count)
+        block_ref_count.resize(num_fingerprints, 0);
+    m_system_block_ref_count.resize(num_fingerprints, 0);
+
+    std::vector<int> file_to_volume(m_number_of_files_for_clustering, NO_VOLUME);
+    int volume_index = 0;
+    for(const auto& workload_files: m_initial_mapping){
+        for(const int file_index: workload_files.second)
+            file_to_volume[file_index] = volume_index;
+        ++volume_index;
+    }
+
+    for(int file_index = 0; file_index < m_number_of_files_for_clustering; ++file_index){
+        if(file_to_volume[file_index] == m_file_to_counted_volume[file_index])
+            continue;
+
+        if(m_file_to_counted_volume[file_index] != NO_VOLUME)
+            updateBlocksRefCountsWithFile(file_index, m_file_to_counted_volume[file_index], -1);
+
+        if(file_to_volume[file_index] != NO_VOLUME)
+            updateBlocksRefCountsWithFile(file_index, file_to_volume[file_index], 1);
+
+        m_file_to_counted_volume[file_index] = file_to_volume[file_index];
+    }
+}
+
+void AlgorithmDSManager::updateBlocksRefCountsWithFile(const int file_index, const int volume_index,
+                                                       const int ref_count_diff){
+    m_file_blocks_index.forEachBlockInFile(file_index, [&](const int block_index){
+        const int block_size = m_fingerprint_to_size[block_index];
+
+        int& volume_ref_count = m_volume_block_ref_count[volume_index][block_index];
+        if(volume_ref_count == 0 || volume_ref_count + ref_count_diff == 0)
+            m_volume_size_with_deduplication[volume_index] += ref_count_diff * block_size;
+        volume_ref_count += ref_count_diff;
+
+        int& system_ref_count = m_system_block_ref_count[block_index];
+        if(system_ref_count == 0 || system_ref_count + ref_count_diff == 0)
+            m_system_size_with_deduplication += ref_count_diff * block_size;
+        system_ref_count += ref_count_diff;
+    });
+}
+
+void AlgorithmDSManager::updateAppearancesMatWithFileRecipe(
+        const WorkloadsFilesRecipes& files_recipes,
+        const std::vector<int>& block_sn_to_fingerprint_index,
         const int file_index,
-        std::unordered_set<int>& current_volume,
-        std::unordered_set<int>& optimal_volumes,
+        std::vector<int>& fingerprint_counted_volume,
+        std::vector<bool>& fingerprint_counted_in_system,
         const bool is_only_appearances_mat){
-    const int number_of_blocks_in_file_line = Utility::getNumOfBlockInFile(splitted_line_content);
-
-    const std::string input_file = Utility::getInputFileOfFile(splitted_line_content);
+    const std::string& input_file = files_recipes.input_file[file_index];
     m_input_file_to_file_index[input_file] = file_index;
     m_file_index_to_input_file[file_index] = input_file;
 
+    const int volume_index = files_recipes.workload_index[file_index];
+
     //for each fp for this file if the fp was selected, add to relevant data structures
-    for (int block_index = 0; block_index < number_of_blocks_in_file_line; ++block_index) {
-        const int block_sn = Utility::getBlockSNInFileByIndex(splitted_line_content, block_index);
-        const int fingerprint_index = Utility::binarySearch(
-                fingerprints_for_clustering_ordered_by_SN,
-                0,
-                fingerprints_for_clustering_ordered_by_SN.size() - 1,
-                block_sn);
-
-        static constexpr int FINGERPRINT_NOT_FOUND = -1;
-        if (fingerprint_index == FINGERPRINT_NOT_FOUND)
+    for (size_t block_offset = files_recipes.first_block_offset[file_index];
+         block_offset < files_recipes.first_block_offset[file_index + 1]; ++block_offset) {
+        const int block_sn = files_recipes.block_sns[block_offset];
+        if (block_sn < 0 || block_sn >= block_sn_to_fingerprint_index.size() ||
+            block_sn_to_fingerprint_index[block_sn] == NOT_SELECTED_FINGERPRINT)
             continue;
 
-        const int block_size= Utility::getBlockSizeInFileByIndex(splitted_line_content, block_index);
-        m_appearances_matrix[file_index][fingerprint_index] = true;
+        const int fingerprint_index = block_sn_to_fingerprint_index[block_sn];
+        const int block_size = files_recipes.block_sizes[block_offset];
+        m_appearances_matrix.set(file_index, fingerprint_index);
         m_file_to_size[file_index] += block_size;
         m_fingerprint_to_size[fingerprint_index] = block_size;
         m_max_block_sn=std::max(m_max_block_sn, block_sn);
 
         if(!is_only_appearances_mat){
             //new fp for specific volume
-            if (current_volume.insert(fingerprint_index).second)
+            if (fingerprint_counted_volume[fingerprint_index] != volume_index) {
+                fingerprint_counted_volume[fingerprint_index] = volume_index;
                 m_initial_system_size_with_deduplication += block_size;
+            }
 
             //new fp for entire system
-            if (optimal_volumes.insert(fingerprint_index).second)
+            if (!fingerprint_counted_in_system[fingerprint_index]) {
+                fingerprint_counted_in_system[fingerprint_index] = true;
                 m_optimal_system_size_with_deduplication += block_size;
+            }
         }
     }
 }
 
 void AlgorithmDSManager::initializeAppearancesMatrix(
+        const WorkloadsFilesRecipes& files_recipes,
         const std::vector<int>& fingerprints_for_clustering_ordered_by_SN,
         bool load_balance, const bool is_only_appearances_mat) {
 
     clearAppearancesMatrix();
+    m_file_blocks_index.clear();
 
     //initialize fields
-    m_fingerprint_to_size = {};
-    m_file_to_size = {};
-    m_file_index_to_input_file = {};
+    m_fingerprint_to_size.assign(m_number_of_fingerprints_for_clustering, 0);
+    m_file_to_size.assign(m_number_of_files_for_clustering, 0);
+    m_file_index_to_input_file.assign(m_number_of_files_for_clustering, "");
     m_input_file_to_file_index = {};
     m_initial_system_size_with_deduplication = 0;
     m_optimal_system_size_with_deduplication = 0;
+    m_file_to_counted_volume = {};
+    m_volume_block_ref_count = {};
+    m_system_block_ref_count = {};
+    m_volume_size_with_deduplication = {};
+    m_system_size_with_deduplication = 0;
+
+    // the selected fingerprints are ordered by their sn, so the last one has the max sn
+    std::vector<int> block_sn_to_fingerprint_index(
+            fingerprints_for_clustering_ordered_by_SN.empty() ? 0 : fingerprints_for_clustering_ordered_by_SN.back() + 1,
+            NOT_SELECTED_FINGERPRINT);
+    for (int fingerprint_index = 0; fingerprint_index < fingerprints_for_clustering_ordered_by_SN.size(); ++fingerprint_index)
+        block_sn_to_fingerprint_index[fingerprints_for_clustering_ordered_by_SN[fingerprint_index]] = fingerprint_index;
+
+    //the last volume whose initial size counted every fp, and whether the optimal (single volume) size counted it
+    static constexpr int NO_VOLUME = -1;
+    std::vector<int> fingerprint_counted_volume(m_number_of_fingerprints_for_clustering, NO_VOLUME);
+    std::vector<bool> fingerprint_counted_in_system(m_number_of_fingerprints_for_clustering, false);
+
+    for (int file_index = 0; file_index < m_number_of_files_for_clustering; ++file_index) {
+        updateAppearancesMatWithFileRecipe(files_recipes, block_sn_to_fingerprint_index, file_index,
+                                           fingerprint_counted_volume, fingerprint_counted_in_system,
+                                           is_only_appearances_mat);
+    }
 
-    std::unordered_set<int> optimal_volumes_size;//fps when all fps in same volume
-    int file_index = 0;
-    std::vector<std::ifstream> workloads_streams = getWorkloadsStreams();
-    for (auto & workloads_stream : workloads_streams) {
-        //fps for specific initial volume
-        std::unordered_set<int> current_volume;
-
-        std::string workload_file_line;
-        while (std::getline(workloads_stream, workload_file_line)) {
-            if(workload_file_line.length() == 0){
-                continue;
-            }
-            const std::vector<std::string> splitted_line_content = Utility::splitString(workload_file_line, ',');
-            if(!Utility::isWorkloadFileLine(splitted_line_content))
-                continue;
-
-            m_file_to_size[file_index] = 0;
+    m_file_blocks_index.indexNewFiles(m_appearances_matrix);
+}
 
-            //if we got here it is file line
-            updateAppearancesMatWithWorkloadFileLine(fingerprints_for_clustering_ordered_by_SN, splitted_line_content,
-                                                     file_index, current_volume, optimal_volumes_size, is_only_appearances_mat);
+void AlgorithmDSManager::updateDissimilaritiesMatrix() {
+    if (!m_is_dissimilarities_matrix_needed)
+        return;
 
-            file_index++;
-        }
+    if (m_minhash_lsh) {
+        updateCandidateDissimilarities();
+        return;
     }
 
-    closeWorkloadsStreams(workloads_streams);
-}
+    const auto start_time = std::chrono::high_resolution_clock::now();
+
+    // the distances between the files already in the matrix never change (files' contents are immutable), only the
+    // cells of files which were added since the last update are calculated
+    const int first_new_file = m_dissimilarities_matrix->getNumberOfRows();
+    m_dissimilarities_matrix->resize(m_number_of_files_for_clustering);
+    if (m_exact_dissimilarities_matrix)
+        m_exact_dissimilarities_matrix->resize(m_number_of_files_for_clustering);
+
+    // the upper triangle is built in square tiles of tile_size x tile_size cells, a tile compares tile_size rows of
+    // the appearances matrix with other tile_size rows, so the tile size is chosen for both to fit in the L2 cache.
+    // the cells are written to the triangles the storage keeps, a tile's cells are in tile_size rows of either one
+    static constexpr int L2_CACHE_BUDGET_BYTES = 256 * 1024;
+    static constexpr int MIN_TILE_SIZE = 8;
+    static constexpr int MAX_TILE_SIZE = 128;
+    const int row_bytes = m_appearances_matrix.getNumWordsInRow() * sizeof(BitMatrix::Word);
+    const int tile_size = std::max(MIN_TILE_SIZE, std::min(MAX_TILE_SIZE, L2_CACHE_BUDGET_BYTES / std::max(1, 2 * row_bytes)));
+    const int num_tiles_in_row = (m_number_of_files_for_clustering + tile_size - 1) / tile_size;
+
+    // only tiles which have columns of new files
+    std::vector<std::pair<int, int>> tiles;
+    for (int tile_row = 0; tile_row < num_tiles_in_row; ++tile_row) {
+        for (int tile_column = std::max(tile_row, first_new_file / tile_size); tile_column < num_tiles_in_row; ++tile_column)
+            tiles.emplace_back(tile_row, tile_column);
+    }
 
-void AlgorithmDSManager::initializeDissimilaritiesMatrix() {
-    std::unordered_map<int, int> initial_clusters = getInitialFileToClusterMapping();
+    std::vector<bool> is_file_removed(m_number_of_files_for_clustering, false);
+    for (const int removed_file : m_removed_files)
+        is_file_removed[removed_file] = true;
+
+    static constexpr int NUM_PROGRESS_REPORTS = 4;
+    std::atomic<int> num_finished_tiles(0);
+    std::mutex output_lock;
+
+    Utility::runInParallel(tiles.size(), m_num_threads, [&](const int tile_index, const int){
+        const int first_row = tiles[tile_index].first * tile_size;
+        const int last_row = std::min(first_row + tile_size, m_number_of_files_for_clustering);
+        const int first_column = std::max(tiles[tile_index].second * tile_size, first_new_file);
+        const int last_column = std::min(tiles[tile_index].second * tile_size + tile_size, m_number_of_files_for_clustering);
+
+        for (int i = first_row; i < last_row; ++i) {
+            // fill the diagonal - irrelevant
+            if (i >= first_column)
+                setDissimilarityCell(i, i, {0});
+
+            // the cells of removed files are never read (the clustering deactivates removed files), so their distances
+            // are not calculated
+            for (int j = std::max(i + 1, first_column); j < last_column; ++j) {
+                setDissimilarityCell(i, j, {is_file_removed[i] || is_file_removed[j] ?
+                                            DBL_MAX : m_appearances_matrix.getJaccardDistance(i, j)});
+            }
+        }
 
-    //create the dissimilarity_matrix, do it row by row
-    m_dissimilarities_matrix = std::vector<std::vector<DissimilarityCell>>();
-    m_dissimilarities_matrix.reserve(m_number_of_files_for_clustering);
+        // report whenever another quarter of the tiles is done
+        const int finished_tiles = ++num_finished_tiles;
+        if (finished_tiles * NUM_PROGRESS_REPORTS / tiles.size() != (finished_tiles - 1) * NUM_PROGRESS_REPORTS / tiles.size() &&
+            finished_tiles != tiles.size()) {
+            std::lock_guard<std::mutex> guard(output_lock);
+            std::cout << "updateDissimilaritiesMatrix progress: " << finished_tiles * 100 / tiles.size() << "% ("
+                      << finished_tiles << "/" << tiles.size() << " tiles)" << std::endl;
+        }
+    });
+
+    std::cout<< "Finished initializeDissimilaritiesMatrix. files=" << m_number_of_files_for_clustering
+             << ", new files=" << m_number_of_files_for_clustering - first_new_file << ", precision="
+             << DissimilaritiesMatrix::getPrecisionName(m_dissimilarities_matrix->getPrecision())
+             << (m_exact_dissimilarities_matrix ? " (with an exact copy)" : "")
+             << ", threads=" << m_num_threads << ", took="
+             << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::high_resolution_clock::now() - start_time).count() << "ms" << std::endl;
+}
 
+void AlgorithmDSManager::updateCandidateDissimilarities() {
+    const auto start_time = std::chrono::high_resolution_clock::now();
+
+    // files' contents are immutable, so only the signatures of the new files are calculated
+    const int first_new_file = m_minhash_signatures.size();
+    m_minhash_signatures.resize(m_number_of_files_for_clustering);
+    Utility::runInParallel(m_number_of_files_for_clustering - first_new_file, m_num_threads,
+                           [this, first_new_file](const int file_offset, const int){
+        const int file_index = first_new_file + file_offset;
+        m_minhash_signatures[file_index] = m_minhash_lsh->getSignature(m_file_blocks_index.getBlocksInFile(file_index));
+    });
+
+    // the buckets of the old files may get new files (and lose removed files), so all the candidate pairs are
+    // collected again. the cells of the pairs are exact
+    const std::vector<std::vector<int>> candidate_pairs = m_minhash_lsh->getCandidatePairs(m_minhash_signatures,
+                                                                                           m_removed_files);
+    m_candidate_dissimilarities.assign(m_number_of_files_for_clustering, {});
+    Utility::runInParallel(m_number_of_files_for_clustering, m_num_threads, [&](const int i, const int){
+        m_candidate_dissimilarities[i].reserve(candidate_pairs[i].size());
+        for (const int j : candidate_pairs[i])
+            m_candidate_dissimilarities[i].emplace_back(j, DissimilarityCell(m_appearances_matrix.getJaccardDistance(i, j)));
+    });
+
+    // every pair (i, j < i) is added to j's cells as well, the rows are visited in ascending order so the cells of j
+    // stay ordered (the cells of the pairs with files greater than j follow the ones of the smaller files)
     for (int i = 0; i < m_number_of_files_for_clustering; ++i) {
-        m_dissimilarities_matrix.emplace_back(m_number_of_files_for_clustering);
+        for (const auto& cell : m_candidate_dissimilarities[i]) {
+            if (cell.first > i)
+                break;
 
-        // fill the diagonal - irrelevant
-        m_dissimilarities_matrix[i][i] = {0, {std::make_pair(initial_clusters[i], m_file_to_size[i])}};
+            m_candidate_dissimilarities[cell.first].emplace_back(i, cell.second);
+        }
+    }
 
-        for (int j = i + 1; j < m_number_of_files_for_clustering; ++j) {
-            const float distance = Utility::getJaccardDistance(m_appearances_matrix[i],m_appearances_matrix[j]);
+    long long num_candidate_pairs = 0;
+    for (const auto& file_candidate_pairs : candidate_pairs)
+        num_candidate_pairs += file_candidate_pairs.size();
+
+    const long long num_pairs = static_cast<long long>(m_number_of_files_for_clustering) *
+                                (m_number_of_files_for_clustering - 1) / 2;
+    std::cout<< "Finished initializeDissimilaritiesMatrix (LSH bands=" << m_minhash_lsh->getNumBands()
+             << ", rows per band=" << m_minhash_lsh->getRowsPerBand() << "). files=" << m_number_of_files_for_clustering
+             << ", new files=" << m_number_of_files_for_clustering - first_new_file
+             << ", candidate pairs=" << num_candidate_pairs << " of " << num_pairs << " ("
+             << (num_pairs == 0 ? 0 : 100.0 * num_candidate_pairs / num_pairs) << "%)"
+             << ", threads=" << m_num_threads << ", took="
+             << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::high_resolution_clock::now() - start_time).count() << "ms" << std::endl;
+}
 
-            std::map<int,long long int > size_in_orig_clusters = {std::make_pair(initial_clusters[i], m_file_to_size[i])};
-            if(initial_clusters[i] == initial_clusters[j])
-            {
-                size_in_orig_clusters[initial_clusters[j]] += m_file_to_size[j];
-            }
-            else
-            {
-                size_in_orig_clusters[initial_clusters[j]] = m_file_to_size[j];
+const AlgorithmDSManager::DissimilarityCell& AlgorithmDSManager::getCandidateDissimilarityCell(const int row,
+                                                                                                const int column) const{
+    const std::vector<std::pair<int, DissimilarityCell>>& row_cells = m_candidate_dissimilarities[row];
+    const auto cell_it = std::lower_bound(row_cells.begin(), row_cells.end(), column,
+                                          [](const std::pair<int, DissimilarityCell>& cell, const int cell_column){
+        return cell.first < cell_column;
+    });
 
-            }
+    if (cell_it == row_cells.end() || cell_it->first != column)
+        return NON_CANDIDATE_CELL;
 
-            m_dissimilarities_matrix[i][j] = {distance, size_in_orig_clusters};
-        }
-    }
+    return cell_it->second;
+}
 
-    resetDMBottomTriangle();
+void AlgorithmDSManager::initializeFileSizeFromOriginClusters() {
+    // every file starts with its own size from its cluster in the current initial mapping, removed files hold nothing
+    m_file_size_from_origin_clusters = std::vector<OriginClustersSizes>(m_number_of_files_for_clustering);
 
-    for(const auto& removed_file: m_removed_files){
-        deactivateClusterInDissimilarityMat(removed_file);
+    int origin_cluster = 0;
+    for (const auto& cluster_name_set : m_initial_mapping) {
+        for (const int file_index : cluster_name_set.second) {
+            if (!isFileRemoved(file_index))
+                m_file_size_from_origin_clusters[file_index] = {std::make_pair(origin_cluster, m_file_to_size[file_index])};
+        }
+        ++origin_cluster;
     }
-
-    std::cout<< "Finished initializeDissimilaritiesMatrix" <<std::endl;
 }
 
 std::unordered_map<int,int> AlgorithmDSManager::getFileToClusterMapping(const std::map<std::string, std::set<int>>& clustering){
@@ -678,43 +959,15 @@ const std::string& AlgorithmDSManager::getCurrentHostName(){
     return m_host_name;
 }
 
-void AlgorithmDSManager::resetDMDiagonal(){
-    std::unordered_map<int, int> initial_clusters = getInitialFileToClusterMapping();
-
-    for (int i = 0; i < m_dissimilarities_matrix.size(); ++i) {
-        // fill the diagonal - irrelevant
-        m_dissimilarities_matrix[i][i] = {0, {std::make_pair(initial_clusters[i], m_file_to_size[i])}};
-    }
-}
-
-void AlgorithmDSManager::resetDMBottomTriangle(){
-    // fill the bottom half
-    for (int i = 0; i < m_dissimilarities_matrix.size(); ++i) {
-        for (int j = 0; j < i; ++j) {
-            m_dissimilarities_matrix[i][j] = m_dissimilarities_matrix[j][i];
-        }
-    }
-}
-
-const AlgorithmDSManager::DissimilarityCell& AlgorithmDSManager::getDissimilarityCell(const int cluster1, const int cluster2) const{
-
-    const int column=std::min(cluster1,cluster2);
-    const int row=std::max(cluster1,cluster2);
-
-    return m_dissimilarities_matrix[row][column];
-}
-
 void AlgorithmDSManager::setDissimilarityCell(const int cluster1, const int cluster2,
                                               const AlgorithmDSManager::DissimilarityCell& dissimilarity_cell){
-    const int column=std::min(cluster1,cluster2);
-    const int row=std::max(cluster1,cluster2);
-
-    m_dissimilarities_matrix[row][column] = dissimilarity_cell;
+    m_dissimilarities_matrix->setCell(cluster1, cluster2, dissimilarity_cell);
+    if (m_exact_dissimilarities_matrix)
+        m_exact_dissimilarities_matrix->setCell(cluster1, cluster2, dissimilarity_cell);
 }
 
-void AlgorithmDSManager::deactivateClusterInDissimilarityMat(const int cluster_index){
-    for (int i = 0; i < m_dissimilarities_matrix.size(); ++i)
-        setDissimilarityCell(cluster_index, i, {DBL_MAX, {}});
+const OriginClustersSizes& AlgorithmDSManager::getFileSizeFromOriginClusters(const int file_index) const{
+    return m_file_size_from_origin_clusters[file_index];
 }
 
 int AlgorithmDSManager::getNumberOfFilesForClustering() const{
@@ -734,23 +987,33 @@ int AlgorithmDSManager::getNumberOfFingerprintsForClustering() const{
 }
 
 int AlgorithmDSManager::getFingerprintSize(const int fp_index) const{
-    return m_fingerprint_to_size.at(fp_index);
+    return m_fingerprint_to_size[fp_index];
 }
 
 int AlgorithmDSManager::getFileSize(const int file_index) const{
-    return m_file_to_size.at(file_index);
+    return m_file_to_size[file_index];
 }
 
 bool AlgorithmDSManager::isFileHasFingerprint(const int file_index, const int fp_index) const{
-    return m_appearances_matrix[file_index][fp_index];
+    return m_appearances_matrix.get(file_index, fp_index);
 }
 
 int AlgorithmDSManager::getFileIndex(const int file_sn) const{
-    return m_file_sn_to_algo_index.at(file_sn);
+    if(file_sn < 0 || file_sn >= m_file_sn_to_algo_index.size() || m_file_sn_to_algo_index[file_sn] == NO_FILE_INDEX)
+        throw std::out_of_range("unknown file sn " + std::to_string(file_sn));
+
+    return m_file_sn_to_algo_index[file_sn];
 }
 
 int AlgorithmDSManager::getFileSN(const int file_index) const{
-    return m_file_index_to_sn.at(file_index);
+    return m_file_index_to_sn[file_index];
+}
+
+void AlgorithmDSManager::setFileSNIndex(const int file_sn, const int file_index){
+    if(file_sn >= m_file_sn_to_algo_index.size())
+        m_file_sn_to_algo_index.resize(file_sn + 1, NO_FILE_INDEX);
+
+    m_file_sn_to_algo_index[file_sn] = file_index;
 }
 
 std::vector<std::set<int>> AlgorithmDSManager::getInitialClusteringAsVector() const{
@@ -796,10 +1059,6 @@ long long int AlgorithmDSManager::getOptimalSystemSize() const{
     return m_optimal_system_size_with_deduplication;
 }
 
-const std::map<int, int>& AlgorithmDSManager::getBlockToSizeMap() const {
-    return m_fingerprint_to_size;
-}
-
 std::map<std::string, double> AlgorithmDSManager::getArrangedLbSizes(const std::vector<double> &lb_sizes) const {
     std::map<std::string, double> arranged_result;
     for(int i=0; i< lb_sizes.size(); ++i)
@@ -823,5 +1082,11 @@ applyPlan(const std::map<std::string, std::set<int>> &clustering, const long lon
     m_initial_mapping = clustering;
     m_initial_system_size_with_deduplication = system_size;
 
-    initializeDissimilaritiesMatrix();
+    // only the origin clusters changed, the distances between the files stay the same
+    initializeFileSizeFromOriginClusters();
+    m_version++;
+}
+
+int AlgorithmDSManager::getVersion() const{
+    return m_version;
 }
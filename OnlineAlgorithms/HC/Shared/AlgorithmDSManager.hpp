@@ -1,9 +1,17 @@
 #pragma once
 
 #include "Utility.hpp"
-
+#include "BitMatrix.hpp"
+#include "OriginClustersSizes.hpp"
+#include "MinHashLsh.hpp"
+#include "FileBlocksIndex.hpp"
+#include "CsvTokenizer.hpp"
+#include "IngestionSnapshot.hpp"
+#include "FingerprintSampler.hpp"
+#include "DissimilaritiesMatrix.hpp"
+
+#include <algorithm>
 #include <fstream>
-#include <queue>
 #include <unordered_map>
 #include <memory>
 #include <set>
@@ -14,23 +22,17 @@
 
 class AlgorithmDSManager final {
 public:
-    /**
-     * DissimilarityCell struct - a cell value for each cell in dissimilarity matrix
-     */
-    struct DissimilarityCell {
-        DissimilarityCell() : jaccard_distance(0), size_from_origin_clusters()
-        {
-        }
+    // the cell of the dissimilarities matrix, see DissimilaritiesMatrix.hpp
+    using DissimilarityCell = ::DissimilarityCell;
 
-        DissimilarityCell(const double jaccard_distance, std::map<int, long long int> size_from_origin_clusters) :
-        jaccard_distance(jaccard_distance),
-        size_from_origin_clusters(std::move(size_from_origin_clusters))
-        {
-        }
+    // the algo index of a file sn which is not in the system
+    static constexpr int NO_FILE_INDEX = -1;
 
-        double jaccard_distance;
-        std::map<int, long long int> size_from_origin_clusters;
-    };
+    // the host of a file which is not in the files index
+    static constexpr int NO_HOST = -1;
+
+    // the cell of a pair which is not an LSH candidate pair, the files are taken as files without shared blocks
+    static const DissimilarityCell NON_CANDIDATE_CELL;
 
 
     enum ChangeType{
@@ -75,6 +77,21 @@ public:
      * @param workloads_paths - paths' vector to the workloads
      * @param requested_number_of_fingerprints - how many fps to use
      * @param load_balance - whether to use load balance or not
+     * @param num_threads - num of threads used to build the dissimilarities matrix
+     * @param lsh_num_bands - num of LSH bands, 0 to calculate the exact dissimilarities matrix. otherwise only the cells
+     *                        of candidate pairs are calculated and kept, see getDissimilarityCell
+     * @param lsh_rows_per_band - num of min hashes in every LSH band (relevant only in case lsh_num_bands > 0)
+     * @param snapshot_dir - directory of the ingestion snapshots, "" to always read the workloads. the state built by
+     *                       reading the workloads is loaded from its snapshot in case a valid one exists, and is saved
+     *                       to a snapshot otherwise
+     * @param is_dissimilarities_matrix_needed - whether to calculate the dissimilarities between the files, false in
+     *                                           case the clustering is not of the files (see SuperNodes)
+     * @param dissimilarities_matrix_dir - directory of the dissimilarities matrix's memory mapped file,
+     *                                     DissimilaritiesMatrix::IN_MEMORY to keep the matrix in memory
+     * @param dissimilarities_precision - the precision of the dissimilarities matrix's distances
+     * @param keep_exact_dissimilarities - whether to keep an exact (float32, in memory) dissimilarities matrix as well
+     *                                     in case the dissimilarities matrix is not exact, see
+     *                                     getExactDissimilarityCell
      */
     explicit AlgorithmDSManager(const std::vector<std::string>& workloads_paths,
                                 const int requested_number_of_fingerprints,
@@ -86,7 +103,17 @@ public:
                                 const bool load_balance,
                                 const ChangeType change_type,
                                 const int num_runs = 1,
-                                const bool is_only_appearances_mat = false);
+                                const bool is_only_appearances_mat = false,
+                                const int num_threads = 1,
+                                const int lsh_num_bands = 0,
+                                const int lsh_rows_per_band = 0,
+                                const std::string& snapshot_dir = "",
+                                const bool is_dissimilarities_matrix_needed = true,
+                                const std::string& dissimilarities_matrix_dir = DissimilaritiesMatrix::IN_MEMORY,
+                                const DissimilaritiesMatrix::Precision dissimilarities_precision =
+                                        DissimilaritiesMatrix::Precision::FLOAT32,
+                                const bool keep_exact_dissimilarities = false);
+    AlgorithmDSManager(const AlgorithmDSManager&) = delete;
     AlgorithmDSManager& operator=(const AlgorithmDSManager&) = delete;
     ~AlgorithmDSManager() = default;
 
@@ -97,38 +124,70 @@ public:
 
     /**
      *
-     * resets the dissimilarities matrix's bottom triangle by copying corresponding values from its upper triangle
+     * @param cluster1 - a cluster index
+     * @param cluster2 - a cluster index
+     * @return the dissimilarity cell between cluster1 and cluster2 (as written in the dissimilarities matrix). with
+     * LSH, a pair which is not a candidate pair is taken as a pair without shared blocks (NON_CANDIDATE_CELL)
      */
-    void resetDMBottomTriangle();
+    DissimilarityCell getDissimilarityCell(const int cluster1, const int cluster2) const{
+        if (m_minhash_lsh)
+            return getCandidateDissimilarityCell(cluster1, cluster2);
 
-    /**
-     *
-     * resets the dissimilarities matrix's diagonal
-     */
-    void resetDMDiagonal();
+        // in case both triangles are kept, the cell is read from cluster1's row so scanning a row reads it in place
+        return m_dissimilarities_matrix->getCell(cluster1, cluster2);
+    }
 
     /**
-     *
      * @param cluster1 - a cluster index
      * @param cluster2 - a cluster index
-     * @return the dissimilarity cell between cluster1 and cluster2 (as written in the dissimilarities matrix)
+     * @return the exact dissimilarity cell between cluster1 and cluster2, the same as getDissimilarityCell in case the
+     * dissimilarities matrix is exact or no exact matrix is kept (see keep_exact_dissimilarities)
+     */
+    DissimilarityCell getExactDissimilarityCell(const int cluster1, const int cluster2) const{
+        if (m_exact_dissimilarities_matrix)
+            return m_exact_dissimilarities_matrix->getCell(cluster1, cluster2);
+
+        return getDissimilarityCell(cluster1, cluster2);
+    }
+
+    /**
+     * hints that the dissimilarities matrix's rows of the given files are about to be read (relevant only in case the
+     * matrix is in a memory mapped file)
+     * @param first_file - file's algo index of the first row
+     * @param last_file - one past the file's algo index of the last row
+     */
+    void prefetchDissimilarityRows(const int first_file, const int last_file) const{
+        if (!m_minhash_lsh)
+            m_dissimilarities_matrix->prefetchRows(first_file, last_file);
+    }
+
+    /**
+     * @return whether only the cells of LSH candidate pairs are kept
      */
-    const DissimilarityCell& getDissimilarityCell(const int cluster1, const int cluster2) const;
+    bool isUsingLsh() const {return m_minhash_lsh != nullptr;}
+
+    /**
+     * @param file_index - file's algo index
+     * @return (j, cell) of every LSH candidate pair of the file, ordered by j (only with LSH)
+     */
+    const std::vector<std::pair<int, DissimilarityCell>>& getCandidateCells(const int file_index) const{
+        return m_candidate_dissimilarities[file_index];
+    }
 
     /**
      *
      * @param cluster1 - a cluster index
      * @param cluster2 - a cluster index
      * @param dissimilarity_cell - a DissimilarityCell object
-     * set the relevant cluster1,cluster2 dissimilarities matrix's cell to be the given dissimilarity_cell
+     * set the relevant cluster1,cluster2 dissimilarities matrix's cells (both of them) to be the given dissimilarity_cell
      */
     void setDissimilarityCell(const int cluster1, const int cluster2, const DissimilarityCell& dissimilarity_cell);
 
     /**
-     * deactivate the given cluster in the dissimilarity matrix
-     * @param cluster_index - a cluster index
+     * @param file_index - file's algo index
+     * @return the size the file holds from its origin cluster (empty for removed files)
      */
-    void deactivateClusterInDissimilarityMat(const int cluster_index);
+    const OriginClustersSizes& getFileSizeFromOriginClusters(const int file_index) const;
 
     /**
      *
@@ -218,12 +277,17 @@ public:
     /**
      * get the appearances matrix
      */
-    const std::vector<std::vector<bool>>& getAppearancesMatrix() const {return m_appearances_matrix;}
+    const BitMatrix& getAppearancesMatrix() const {return m_appearances_matrix;}
 
     /**
-     * get block to size mapping
+     * get the index of the blocks of every file (of the appearances matrix)
      */
-    const std::map<int, int>& getBlockToSizeMap() const;
+    const FileBlocksIndex& getFileBlocksIndex() const {return m_file_blocks_index;}
+
+    /**
+     * get block to size mapping, indexed by the fingerprint's algo index
+     */
+    const std::vector<int>& getBlockToSize() const {return m_fingerprint_to_size;}
 
     /**
      * @param lb_sizes - a lb sizes vector
@@ -233,6 +297,12 @@ public:
 
     void applyPlan(const std::map<std::string, std::set<int>>& clustering, const long long int system_size);
 
+    /**
+     * @return the version of the clustering inputs (files, dissimilarities and initial mapping), it is advanced
+     * whenever changes are applied to the system or a plan is applied
+     */
+    int getVersion() const;
+
     /**
      *
      * @return - the initial state files' algorithm sn to cluster mapping
@@ -263,6 +333,11 @@ public:
 
     int getHostByPath(const std::string& path);
 
+    /**
+     * @return file's algo index to its host (as given by the files index), NO_HOST for files which are not in it
+     */
+    std::vector<int> getFilesHosts() const;
+
     /**
      * @param change_iter - a change iter index
      * @return - map of volume to the set of file indices that was inserted to it at the given change iter
@@ -282,9 +357,54 @@ public:
 
 private:
     /**
-     * initialize the Fingerprint related Data structures and returns the selected fps ordered by their SN
+     * the recipes of the workloads' files (file's algo index to its blocks), kept in memory from the single read of
+     * the workloads until the appearances matrix is filled with the selected fingerprints
+     */
+    struct WorkloadsFilesRecipes {
+        WorkloadsFilesRecipes() : first_block_offset(1, 0) {}
+
+        // file's algo index to the index of its workload
+        std::vector<int> workload_index;
+        // file's algo index to its input file
+        std::vector<std::string> input_file;
+        // file's algo index to the offset of its first block, with an extra last offset (the end of the last file)
+        std::vector<size_t> first_block_offset;
+        // the sn and size of every block of every file, file after file
+        std::vector<int> block_sns;
+        std::vector<int> block_sizes;
+    };
+
+    // the fingerprint index of a block which was not selected for clustering
+    static constexpr int NOT_SELECTED_FINGERPRINT = -1;
+
+    /**
+     * reads the workloads (once), initializes the Fingerprint related Data structures and returns the selected fps
+     * ordered by their SN
+     * @param files_recipes - filled with the recipes of the workloads' files
      */
-    std::vector<int> initializeAndSelectFingerprints();
+    std::vector<int> initializeAndSelectFingerprints(WorkloadsFilesRecipes& files_recipes);
+
+    /**
+     * @param is_only_appearances_mat - whether only the appearances matrix is built
+     * @return the key of the ingestion snapshot of the current inputs
+     */
+    IngestionSnapshot::Key getIngestionSnapshotKey(const bool is_only_appearances_mat) const;
+
+    /**
+     * initializes the state built by reading the workloads (instead of initializeAndSelectFingerprints and
+     * initializeAppearancesMatrix) from its snapshot in snapshot_dir, in case a valid one exists
+     * @param snapshot_dir - directory of the ingestion snapshots, "" in case snapshots are not used
+     * @param is_only_appearances_mat - whether only the appearances matrix is built
+     * @return whether the state was loaded from a snapshot
+     */
+    bool loadIngestionSnapshot(const std::string& snapshot_dir, const bool is_only_appearances_mat);
+
+    /**
+     * saves the state built by reading the workloads to a snapshot in snapshot_dir (a failure is only reported)
+     * @param snapshot_dir - directory of the ingestion snapshots, "" in case snapshots are not used
+     * @param is_only_appearances_mat - whether only the appearances matrix is built
+     */
+    void saveIngestionSnapshot(const std::string& snapshot_dir, const bool is_only_appearances_mat) const;
 
     /**
      * @param changes_input_file_path - a change input path path
@@ -325,17 +445,40 @@ private:
                                                               const ChangeType change_type);
     /**
      * initialize the appearances matrix with the initial+optimal system size with deduplication fields
+     * @param files_recipes - the recipes of the workloads' files
      * @param fingerprints_for_clustering_ordered_by_SN - fingerprints for clustering ordered by their SN
      * @param load_balance - whether to calculate load balance stats
      * @return - pair of initial system size and optimal system size
      */
-    void initializeAppearancesMatrix(const std::vector<int>& fingerprints_for_clustering_ordered_by_SN,
+    void initializeAppearancesMatrix(const WorkloadsFilesRecipes& files_recipes,
+                                     const std::vector<int>& fingerprints_for_clustering_ordered_by_SN,
                                      bool load_balance, const bool is_only_appearances_mat);
 
     /**
-     * initialize the final dissimilarity matrix
+     * grows the dissimilarity matrix to hold all the files and calculates the distances of the files which were added
+     * since the last update (all of the files on the first update), the new cells are built in tiles by up to
+     * m_num_threads threads. the distances of removed files are not calculated (the clustering deactivates them).
+     * with LSH, updateCandidateDissimilarities is used instead
      */
-    void initializeDissimilaritiesMatrix();
+    void updateDissimilaritiesMatrix();
+
+    /**
+     * calculates the MinHash signatures of the files which were added since the last update and calculates the cells
+     * of all the LSH candidate pairs again (removed files have none)
+     */
+    void updateCandidateDissimilarities();
+
+    /**
+     * @param row - a file index
+     * @param column - a file index
+     * @return the cell of the candidate pair (row, column), NON_CANDIDATE_CELL in case it is not a candidate pair
+     */
+    const DissimilarityCell& getCandidateDissimilarityCell(const int row, const int column) const;
+
+    /**
+     * initialize the size every file holds from its origin cluster according to the current initial mapping
+     */
+    void initializeFileSizeFromOriginClusters();
 
     /**
      * clears the appearances matrix
@@ -343,44 +486,68 @@ private:
     void clearAppearancesMatrix();
 
     /**
-     * returns vector of workloads' streams (files located at m_workloads_paths)
+     * sets the size of the given fingerprint and updates the deduplicated sizes of the volumes and of the system
+     * which hold it (see updateBlocksRefCounts)
+     * @param fingerprint_index - fingerprint's algo index
+     * @param size - the new size of the fingerprint
+     */
+    void setFingerprintSize(const int fingerprint_index, const int size);
+
+    /**
+     * moves every file whose volume in the initial mapping changed since the last call (added, removed or migrated
+     * files) between the volumes' block ref counts. the first call counts all of the files. the work is proportional
+     * to the num of files plus the num of blocks of the moved files
      */
-    std::vector<std::ifstream> getWorkloadsStreams() const;
+    void updateBlocksRefCounts();
+
+    /**
+     * adds (or removes) the blocks of a file to the block ref counts of a volume, and updates the deduplicated
+     * sizes whenever a block's ref count becomes positive or zero
+     * @param file_index - file's algo index
+     * @param volume_index - index of the volume in the initial mapping
+     * @param ref_count_diff - 1 to add the file's blocks, -1 to remove them
+     */
+    void updateBlocksRefCountsWithFile(const int file_index, const int volume_index, const int ref_count_diff);
+
+    /**
+     * maps a file sn to its algo index, growing the sn to algo index mapping as needed
+     * @param file_sn - a file sn
+     * @param file_index - file's algo index
+     */
+    void setFileSNIndex(const int file_sn, const int file_index);
 
     /**
      * inner function of initializeAndSelectFingerprints
-     * updates the given current_blocks,current_algo_file_index  and minhash_fingerprints
-     * with the given workload file
-     * @param workload_file - a workload's file
+     * reads the workload's (memory mapped) file in a single pass, updates the given current_blocks and
+     * fingerprint_sampler with its blocks and adds its files to the system and to files_recipes
      * @param workload_index - index of the workload's file
-     * @param current_algo_file_index - the current algo file index
-     * @param current_blocks - set of blocks we already handled
-     * @param requested_num_fps - threshold of number of fingerprints we want to collect
-     * @param minhash_fingerprints - priority queue of fingerprints
+     * @param current_blocks - block sn to whether we already handled it
+     * @param fingerprint_sampler - sampler of the fingerprints for clustering
+     * @param files_recipes - the recipes of the files read so far
      */
-    void updateFPWithWorkload(std::ifstream& workload_file, const int workload_index,
-                              int& current_algo_file_index,
-                              std::unordered_set<int>& current_blocks,
-                              const int requested_num_fps,
-                              std::priority_queue<std::pair<std::string, int>>& minhash_fingerprints);
+    void loadWorkload(const int workload_index,
+                      std::vector<bool>& current_blocks,
+                      FingerprintSampler& fingerprint_sampler,
+                      WorkloadsFilesRecipes& files_recipes);
 
     /**
      * inner function of initializeAppearancesMatrix
-     * updates the given initial_volumes_size and optimal_volumes_size
+     * updates the given fingerprint_counted_volume and fingerprint_counted_in_system
      * also updating the class fields: m_appearances_matrix, m_fingerprint_to_size
      * and m_initial_system_size_with_deduplication
-     * @param fingerprints_for_clustering_ordered_by_SN - selected fingerprints ordered by the SN (ascending)
-     * @param splitted_line_content -  a workload line representing a file splitted by ','
+     * @param files_recipes - the recipes of the workloads' files
+     * @param block_sn_to_fingerprint_index - block sn to its fingerprint index, NOT_SELECTED_FINGERPRINT if it was not
+     *                                        selected
      * @param file_index - the current algo file index
-     * @param current_volume - set of blocks we already handled in current volume
-     * @param optimal_volumes - set of blocks we already handled in all volumes
-     */
-    void updateAppearancesMatWithWorkloadFileLine(const std::vector<int>& fingerprints_for_clustering_ordered_by_SN,
-                                                  const std::vector<std::string>& splitted_line_content,
-                                                  const int file_index,
-                                                  std::unordered_set<int>& current_volume,
-                                                  std::unordered_set<int>& optimal_volumes,
-                                                  const bool is_only_appearances_mat);
+     * @param fingerprint_counted_volume - fp to the last volume which counted it in its initial size
+     * @param fingerprint_counted_in_system - fp to whether the optimal system size counted it
+     */
+    void updateAppearancesMatWithFileRecipe(const WorkloadsFilesRecipes& files_recipes,
+                                            const std::vector<int>& block_sn_to_fingerprint_index,
+                                            const int file_index,
+                                            std::vector<int>& fingerprint_counted_volume,
+                                            std::vector<bool>& fingerprint_counted_in_system,
+                                            const bool is_only_appearances_mat);
 private:
     /**
      *
@@ -389,31 +556,33 @@ private:
     static std::unordered_map<int,int> getFileToClusterMapping(const std::map<std::string, std::set<int>>& clustering);
 
     /**
-     * close the workloads' streams as given in workloads_streams
-     * @param workloads_streams - workloads' streams vector
+     * inner function of loadWorkload
+     * updates the given fingerprint_sampler and current_blocks with the given workload block line
+     * @param block_line - a workload line representing a block, after its first field
+     * @param current_blocks - block sn to whether we already handled it
+     * @param fingerprint_sampler - sampler of the fingerprints for clustering
      */
-    static void closeWorkloadsStreams(std::vector<std::ifstream>& workloads_streams);
+    static void updateFPWithWorkloadBlockLine(CsvTokenizer& block_line, std::vector<bool>& current_blocks,
+                                              FingerprintSampler& fingerprint_sampler);
 
     /**
-     * inner function of initializeAndSelectFingerprints
-     * updates the given minhash_fingerprints and current_blocks with the given workload_line
-     * @param splitted_line_content - a workload line representing a block splitted by ','
-     * @param current_blocks - set of blocks we already handled
-     * @param requested_num_fps - threshold of number of fingerprints we want to collect
-     * @param minhash_fingerprints - priority queue of fingerprints
+     * inner function of loadWorkload
+     * adds the recipe of the given workload file line to files_recipes
+     * @param file_line - a workload line representing a file, after its sn field
+     * @param workload_index - index of the file's workload
+     * @param files_recipes - the recipes of the files read so far
      */
-    static void updateFPWithWorkloadBlockLine(const std::vector<std::string>& splitted_line_content,
-                                              std::unordered_set<int>& current_blocks, const int requested_num_fps,
-                                              std::priority_queue<std::pair<std::string, int>>& minhash_fingerprints);
+    static void addWorkloadFileRecipe(CsvTokenizer& file_line, const int workload_index,
+                                      WorkloadsFilesRecipes& files_recipes);
 
     /**
      * inner function of initializeAndSelectFingerprints
-     * @param minhash_fingerprints - priority queue of selected fingerprints
+     * @param fingerprint_sampler - sampler of the fingerprints for clustering, after all the blocks were added to it
+     * @param fp_to_index - filled with the selected fingerprints' algo indices
      * @return selected fingerprints ordered by the SN (ascending)
      */
-    static std::vector<int> getFPForClusteringOrderedBySN(
-            std::priority_queue<std::pair<std::string, int>>& minhash_fingerprints,
-            std::map<std::string, int>& fp_to_index);
+    static std::vector<int> getFPForClusteringOrderedBySN(const FingerprintSampler& fingerprint_sampler,
+                                                          std::map<std::string, int>& fp_to_index);
 
     /**
      * @param paths - paths of the workloads as given by command line
@@ -421,12 +590,25 @@ private:
      */
     static std::vector<std::string> getWorkloadsFullPaths(const std::vector<std::string>& paths);
 
-    // m_dissimilarities_matrix - the dissimilarities' matrix
+    // m_num_threads - num of threads used to build the dissimilarities matrix
+    // m_is_dissimilarities_matrix_needed - whether the dissimilarities matrix is calculated, it is left empty otherwise
+    // m_minhash_lsh - LSH of the files' MinHash signatures, null in case the exact dissimilarities matrix is used
+    // m_minhash_signatures - file's algo index to its MinHash signature (only with LSH)
+    // m_candidate_dissimilarities - per file i, (j, cell) of every candidate pair (i, j) ordered by j (only with LSH),
+    //                               every pair is kept in both files. it replaces the dissimilarities' matrix, which
+    //                               is left empty
+    // m_dissimilarities_matrix - the dissimilarities' matrix, in memory or in a memory mapped file
+    // m_exact_dissimilarities_matrix - exact copy of the dissimilarities' matrix, null unless it is kept (only in case
+    //                                  the dissimilarities' matrix is not exact)
+    // m_file_size_from_origin_clusters - file's algo index to the size it holds from its origin cluster
     // m_appearances_matrix - the appearances' matrix -> is file x contains fp y
+    // m_file_blocks_index - index of the blocks of every file of m_appearances_matrix
     // m_fingerprint_to_size - fingerprint's algo index to size mapping
     // m_initial_mapping - initial system's volume to files set (algo indices) mapping
     // m_workloads_paths - workload paths vector
+    // m_file_to_size - file's algo index to size mapping
     // m_file_index_to_sn - file's algo index to file's sn mapping
+    // m_file_sn_to_algo_index - file's sn to file's algo index mapping, NO_FILE_INDEX for unknown sns
     // m_requested_number_of_fingerprints - number of fingerprints to use, -1 for 'all'
     // m_number_of_files_for_clustering - number of fingerprints to use, -1 for 'all'
     // m_number_of_fingerprints_for_clustering - actual number of fingerprints
@@ -443,17 +625,31 @@ private:
     // m_file_index_to_input_file - algo index to input file name
     // m_input_file_to_file_index - input file to file index
     // m_host_to_file_ordered - map from host to all its files ordered (old to new)
+    // m_file_to_counted_volume - file's algo index to the volume whose block ref counts include it, -1 for none
+    // m_volume_block_ref_count - per volume, fingerprint's algo index to num of files in the volume containing it
+    // m_system_block_ref_count - fingerprint's algo index to num of files in the system containing it
+    // m_volume_size_with_deduplication - per volume, the size of the blocks whose ref count is positive
+    // m_system_size_with_deduplication - the size of the blocks whose system ref count is positive
+    // m_version - the version of the clustering inputs, see getVersion
 private:
-    std::vector<std::vector<DissimilarityCell>> m_dissimilarities_matrix;
-    std::vector<std::vector<bool>> m_appearances_matrix;
-    std::map<int,int> m_fingerprint_to_size;
-    std::map<int,long long int> m_file_to_size;
+    const int m_num_threads;
+    const bool m_is_dissimilarities_matrix_needed;
+    std::unique_ptr<MinHashLsh> m_minhash_lsh;
+    std::vector<MinHashLsh::Signature> m_minhash_signatures;
+    std::vector<std::vector<std::pair<int, DissimilarityCell>>> m_candidate_dissimilarities;
+    std::unique_ptr<DissimilaritiesMatrix> m_dissimilarities_matrix;
+    std::unique_ptr<DissimilaritiesMatrix> m_exact_dissimilarities_matrix;
+    std::vector<OriginClustersSizes> m_file_size_from_origin_clusters;
+    BitMatrix m_appearances_matrix;
+    FileBlocksIndex m_file_blocks_index;
+    std::vector<int> m_fingerprint_to_size;
+    std::vector<long long int> m_file_to_size;
     std::map<std::string, std::set<int>> m_initial_mapping;
     std::vector<std::string> m_workloads_paths;
-    std::map<int, int> m_file_index_to_sn;
-    std::map<int, int> m_file_sn_to_algo_index;
+    std::vector<int> m_file_index_to_sn;
+    std::vector<int> m_file_sn_to_algo_index;
 
-    std::map<int, std::string> m_file_index_to_input_file;
+    std::vector<std::string> m_file_index_to_input_file;
     std::map<std::string, int> m_input_file_to_file_index;
     const int m_requested_number_of_fingerprints;
     int m_number_of_files_for_clustering;
@@ -468,4 +664,10 @@ private:
     std::map<std::string ,int> m_fingerprint_to_index;
     std::string m_change_input_file_path;
     std::map<int, std::vector<std::string>> m_host_to_file_ordered;
+    std::vector<int> m_file_to_counted_volume;
+    std::vector<std::vector<int>> m_volume_block_ref_count;
+    std::vector<int> m_system_block_ref_count;
+    std::vector<long long int> m_volume_size_with_deduplication;
+    long long int m_system_size_with_deduplication;
+    int m_version;
 };
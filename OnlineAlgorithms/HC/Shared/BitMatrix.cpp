@@ -0,0 +1,190 @@
+#include "BitMatrix.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BIT_MATRIX_X86_KERNELS
+#endif
+
+namespace {
+    // a kernel counts the set bits of (row1 or row2) and of (row1 xor row2) over num_words words
+    using JaccardCountsKernel = void (*)(const BitMatrix::Word* row1, const BitMatrix::Word* row2, const int num_words,
+                                         long long& or_count, long long& xor_count);
+
+    void jaccardCountsPortable(const BitMatrix::Word* row1, const BitMatrix::Word* row2, const int num_words,
+                               long long& or_count, long long& xor_count){
+        for (int i = 0; i < num_words; ++i) {
+            or_count += __builtin_popcountll(row1[i] | row2[i]);
+            xor_count += __builtin_popcountll(row1[i] ^ row2[i]);
+        }
+    }
+
+#ifdef BIT_MATRIX_X86_KERNELS
+    __attribute__((target("popcnt")))
+    void jaccardCountsPopcnt(const BitMatrix::Word* row1, const BitMatrix::Word* row2, const int num_words,
+                             long long& or_count, long long& xor_count){
+        for (int i = 0; i < num_words; ++i) {
+            or_count += __builtin_popcountll(row1[i] | row2[i]);
+            xor_count += __builtin_popcountll(row1[i] ^ row2[i]);
+        }
+    }
+
+    // counts the bits of every byte with a nibble lookup table, and sums the bytes into 4 64-bit lanes
+    __attribute__((target("avx2")))
+    inline __m256i popcountAvx2(const __m256i value){
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low_mask = _mm256_set1_epi8(0x0f);
+        const __m256i low_nibbles = _mm256_and_si256(value, low_mask);
+        const __m256i high_nibbles = _mm256_and_si256(_mm256_srli_epi16(value, 4), low_mask);
+        const __m256i byte_counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low_nibbles),
+                                                    _mm256_shuffle_epi8(lookup, high_nibbles));
+
+        return _mm256_sad_epu8(byte_counts, _mm256_setzero_si256());
+    }
+
+    __attribute__((target("avx2")))
+    long long sumLanesAvx2(const __m256i value){
+        alignas(32) long long lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), value);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+
+    __attribute__((target("avx2")))
+    void jaccardCountsAvx2(const BitMatrix::Word* row1, const BitMatrix::Word* row2, const int num_words,
+                           long long& or_count, long long& xor_count){
+        static constexpr int WORDS_IN_VECTOR = 4;
+        __m256i or_counts = _mm256_setzero_si256();
+        __m256i xor_counts = _mm256_setzero_si256();
+
+        for (int i = 0; i < num_words; i += WORDS_IN_VECTOR) {
+            const __m256i words1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(row1 + i));
+            const __m256i words2 = _mm256_load_si256(reinterpret_cast<const __m256i*>(row2 + i));
+            or_counts = _mm256_add_epi64(or_counts, popcountAvx2(_mm256_or_si256(words1, words2)));
+            xor_counts = _mm256_add_epi64(xor_counts, popcountAvx2(_mm256_xor_si256(words1, words2)));
+        }
+
+        or_count += sumLanesAvx2(or_counts);
+        xor_count += sumLanesAvx2(xor_counts);
+    }
+
+    __attribute__((target("avx512f,avx512vpopcntdq")))
+    void jaccardCountsAvx512(const BitMatrix::Word* row1, const BitMatrix::Word* row2, const int num_words,
+                             long long& or_count, long long& xor_count){
+        static constexpr int WORDS_IN_VECTOR = 8;
+        __m512i or_counts = _mm512_setzero_si512();
+        __m512i xor_counts = _mm512_setzero_si512();
+
+        for (int i = 0; i < num_words; i += WORDS_IN_VECTOR) {
+            const __m512i words1 = _mm512_load_si512(row1 + i);
+            const __m512i words2 = _mm512_load_si512(row2 + i);
+            or_counts = _mm512_add_epi64(or_counts, _mm512_popcnt_epi64(_mm512_or_si512(words1, words2)));
+            xor_counts = _mm512_add_epi64(xor_counts, _mm512_popcnt_epi64(_mm512_xor_si512(words1, words2)));
+        }
+
+        or_count += _mm512_reduce_add_epi64(or_counts);
+        xor_count += _mm512_reduce_add_epi64(xor_counts);
+    }
+#endif
+
+    JaccardCountsKernel selectJaccardCountsKernel(){
+#ifdef BIT_MATRIX_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq"))
+            return jaccardCountsAvx512;
+
+        if (__builtin_cpu_supports("avx2"))
+            return jaccardCountsAvx2;
+
+        if (__builtin_cpu_supports("popcnt"))
+            return jaccardCountsPopcnt;
+#endif
+        return jaccardCountsPortable;
+    }
+}
+
+BitMatrix::BitMatrix(const int num_rows, const int num_columns) :
+        m_num_rows(num_rows),
+        m_num_columns(num_columns),
+        m_num_words_in_row(getNumWordsInRow(num_columns)),
+        m_words(static_cast<size_t>(num_rows) * m_num_words_in_row, 0)
+{
+}
+
+int BitMatrix::getNumWordsInRow(const int num_columns) {
+    const int num_words = (num_columns + BITS_IN_WORD - 1) / BITS_IN_WORD;
+    return ((num_words + WORDS_IN_ALIGNMENT - 1) / WORDS_IN_ALIGNMENT) * WORDS_IN_ALIGNMENT;
+}
+
+void BitMatrix::orRow(const int row, const int other_row) {
+    Word* row_words = m_words.data() + static_cast<size_t>(row) * m_num_words_in_row;
+    const Word* other_row_words = getRow(other_row);
+
+    for (int word_index = 0; word_index < m_num_words_in_row; ++word_index)
+        row_words[word_index] |= other_row_words[word_index];
+}
+
+void BitMatrix::orRow(const int row, const BitMatrix& other, const int other_row) {
+    Word* row_words = m_words.data() + static_cast<size_t>(row) * m_num_words_in_row;
+    const Word* other_row_words = other.getRow(other_row);
+
+    for (int word_index = 0; word_index < m_num_words_in_row; ++word_index)
+        row_words[word_index] |= other_row_words[word_index];
+}
+
+void BitMatrix::copyRow(const int row, const BitMatrix& other, const int other_row) {
+    std::copy(other.getRow(other_row), other.getRow(other_row) + m_num_words_in_row,
+              m_words.begin() + static_cast<size_t>(row) * m_num_words_in_row);
+}
+
+void BitMatrix::addRow() {
+    m_words.resize(m_words.size() + m_num_words_in_row, 0);
+    m_num_rows++;
+}
+
+void BitMatrix::reserveColumns(const int num_columns) {
+    if (num_columns <= m_num_columns)
+        return;
+
+    const int new_num_words_in_row = getNumWordsInRow(num_columns);
+    if (new_num_words_in_row != m_num_words_in_row) {
+        // move every row to its new place, the new words of every row are 0
+        std::vector<Word, AlignedAllocator<Word>> new_words(static_cast<size_t>(m_num_rows) * new_num_words_in_row, 0);
+        for (int row = 0; row < m_num_rows; ++row)
+            std::copy(getRow(row), getRow(row) + m_num_words_in_row,
+                      new_words.begin() + static_cast<size_t>(row) * new_num_words_in_row);
+
+        m_words = std::move(new_words);
+        m_num_words_in_row = new_num_words_in_row;
+    }
+
+    m_num_columns = num_columns;
+}
+
+std::vector<int> BitMatrix::getSetColumns(const int row) const {
+    std::vector<int> set_columns;
+    const Word* row_words = getRow(row);
+
+    for (int word_index = 0; word_index < m_num_words_in_row; ++word_index) {
+        // pop the set bits of the word from the lowest
+        for (Word word = row_words[word_index]; word != 0; word &= word - 1)
+            set_columns.push_back(word_index * BITS_IN_WORD + __builtin_ctzll(word));
+    }
+
+    return set_columns;
+}
+
+float BitMatrix::getJaccardDistance(const int row1, const int row2) const {
+    static const JaccardCountsKernel jaccard_counts_kernel = selectJaccardCountsKernel();
+
+    long long or_count = 0;
+    long long xor_count = 0;
+    jaccard_counts_kernel(getRow(row1), getRow(row2), m_num_words_in_row, or_count, xor_count);
+
+    // in case we divide by 0, set value to 0
+    if(or_count == 0)
+        return 0;
+
+    return static_cast<float>(xor_count) / static_cast<float>(or_count);
+}
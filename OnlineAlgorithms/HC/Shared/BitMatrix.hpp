@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/**
+ * a row-major bit matrix stored in one contiguous buffer of 64-bit words.
+ * every row starts on a 64 bytes boundary and is padded with zero bits to a whole number of 64 bytes, so rows can be
+ * compared word by word (or 256/512 bits at a time) without handling a tail
+ */
+class BitMatrix final {
+public:
+    using Word = uint64_t;
+
+    static constexpr int BITS_IN_WORD = 64;
+    static constexpr int ROW_ALIGNMENT_BYTES = 64;
+    static constexpr int WORDS_IN_ALIGNMENT = ROW_ALIGNMENT_BYTES / sizeof(Word);
+
+public:
+    /**
+     * creates a new bit matrix where all the bits are 0
+     * @param num_rows - num of rows
+     * @param num_columns - num of columns
+     */
+    explicit BitMatrix(const int num_rows = 0, const int num_columns = 0);
+
+public:
+    int getNumRows() const {return m_num_rows;}
+    int getNumColumns() const {return m_num_columns;}
+
+    /**
+     * @return num of words in every row (including the padding words)
+     */
+    int getNumWordsInRow() const {return m_num_words_in_row;}
+
+    /**
+     * @param row - a row index
+     * @return a pointer to the row's first word, aligned to ROW_ALIGNMENT_BYTES
+     */
+    const Word* getRow(const int row) const {return m_words.data() + static_cast<size_t>(row) * m_num_words_in_row;}
+    Word* getRow(const int row) {return m_words.data() + static_cast<size_t>(row) * m_num_words_in_row;}
+
+    /**
+     * @param row - a row index
+     * @param column - a column index
+     * @return whether the bit [row, column] is set
+     */
+    bool get(const int row, const int column) const {
+        return (getRow(row)[column / BITS_IN_WORD] >> (column % BITS_IN_WORD)) & 1;
+    }
+
+    /**
+     * sets the bit [row, column]
+     * @param row - a row index
+     * @param column - a column index
+     */
+    void set(const int row, const int column) {
+        m_words[static_cast<size_t>(row) * m_num_words_in_row + column / BITS_IN_WORD] |=
+                Word(1) << (column % BITS_IN_WORD);
+    }
+
+    /**
+     * sets every bit of the row which is set in other_row (row |= other_row)
+     * @param row - a row index
+     * @param other_row - a row index
+     */
+    void orRow(const int row, const int other_row);
+
+    /**
+     * sets every bit of the row which is set in a row of another matrix with the same num of columns
+     * @param row - a row index
+     * @param other - a bit matrix with the same num of columns
+     * @param other_row - a row index in other
+     */
+    void orRow(const int row, const BitMatrix& other, const int other_row);
+
+    /**
+     * copies a row of another matrix with the same num of columns into the row
+     * @param row - a row index
+     * @param other - a bit matrix with the same num of columns
+     * @param other_row - a row index in other
+     */
+    void copyRow(const int row, const BitMatrix& other, const int other_row);
+
+    /**
+     * adds a new row where all the bits are 0
+     */
+    void addRow();
+
+    /**
+     * grows the matrix to have at least num_columns columns, new bits are 0
+     * @param num_columns - requested num of columns
+     */
+    void reserveColumns(const int num_columns);
+
+    /**
+     * @param row - a row index
+     * @return the indices of the set columns of the given row, in ascending order
+     */
+    std::vector<int> getSetColumns(const int row) const;
+
+    /**
+     * @param row1 - a row index
+     * @param row2 - a row index
+     * @return the Jaccard distance between the rows, |row1 xor row2| / |row1 or row2| (0 in case both are empty).
+     * uses the widest popcount implementation supported by the running cpu (AVX-512, AVX2, popcnt or portable)
+     */
+    float getJaccardDistance(const int row1, const int row2) const;
+
+    /**
+     * @param row1 - a row index
+     * @param row2 - a row index (the same row gives the weight of the row)
+     * @param column_weight - callable which returns the weight of a column
+     * @return the sum of the weights of the columns which are set in both rows
+     */
+    template<typename ColumnWeight>
+    long long getIntersectionWeight(const int row1, const int row2, ColumnWeight column_weight) const {
+        return getIntersectionWeight(row1, *this, row2, column_weight);
+    }
+
+    /**
+     * @param row - a row index
+     * @param other - a bit matrix, the columns which only one of the matrices has are not in the intersection
+     * @param other_row - a row index in other
+     * @param column_weight - callable which returns the weight of a column
+     * @return the sum of the weights of the columns which are set in both rows
+     */
+    template<typename ColumnWeight>
+    long long getIntersectionWeight(const int row, const BitMatrix& other, const int other_row,
+                                    ColumnWeight column_weight) const {
+        const Word* row_words = getRow(row);
+        const Word* other_row_words = other.getRow(other_row);
+        const int num_words = std::min(m_num_words_in_row, other.m_num_words_in_row);
+        long long weight = 0;
+
+        for (int word_index = 0; word_index < num_words; ++word_index) {
+            for (Word word = row_words[word_index] & other_row_words[word_index]; word != 0; word &= word - 1)
+                weight += column_weight(word_index * BITS_IN_WORD + __builtin_ctzll(word));
+        }
+
+        return weight;
+    }
+
+private:
+    /**
+     * an allocator which aligns its buffers to ROW_ALIGNMENT_BYTES
+     */
+    template<typename T>
+    struct AlignedAllocator {
+        using value_type = T;
+
+        AlignedAllocator() = default;
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U>&) {}
+
+        T* allocate(const size_t n) {
+            void* buffer = nullptr;
+            if (posix_memalign(&buffer, ROW_ALIGNMENT_BYTES, n * sizeof(T)) != 0)
+                throw std::bad_alloc();
+
+            return static_cast<T*>(buffer);
+        }
+
+        void deallocate(T* buffer, const size_t) {free(buffer);}
+
+        template<typename U>
+        bool operator==(const AlignedAllocator<U>&) const {return true;}
+        template<typename U>
+        bool operator!=(const AlignedAllocator<U>&) const {return false;}
+    };
+
+    static int getNumWordsInRow(const int num_columns);
+
+// m_num_rows - num of rows
+// m_num_columns - num of columns
+// m_num_words_in_row - num of words in every row, a multiple of WORDS_IN_ALIGNMENT
+// m_words - the matrix's words, row after row
+private:
+    int m_num_rows;
+    int m_num_columns;
+    int m_num_words_in_row;
+    std::vector<Word, AlignedAllocator<Word>> m_words;
+};
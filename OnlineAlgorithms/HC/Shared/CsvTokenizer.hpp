@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+/**
+ * splits a csv buffer (such as a mapped workload file) to lines and every line to comma separated fields, without
+ * copying or allocating. fields are returned as is (not trimmed), a '\r' at the end of a line is not part of the line
+ */
+class CsvTokenizer final {
+public:
+    /**
+     * a field of the current line, points into the tokenized buffer
+     */
+    struct Field {
+        const char* begin;
+        const char* end;
+
+        size_t size() const {return end - begin;}
+        std::string toString() const {return std::string(begin, end);}
+        bool operator==(const std::string& str) const {
+            return size() == str.size() && std::memcmp(begin, str.data(), str.size()) == 0;
+        }
+    };
+
+public:
+    /**
+     * @param begin - first byte of the buffer
+     * @param end - one past the last byte of the buffer
+     */
+    CsvTokenizer(const char* begin, const char* end) :
+            m_buffer_end(end), m_next_line(begin), m_line_end(begin), m_next_field(nullptr) {}
+
+public:
+    /**
+     * moves to the next non empty line
+     * @return false in case there are no more lines
+     */
+    bool nextLine() {
+        while (m_next_line != m_buffer_end) {
+            const char* const line_begin = m_next_line;
+            const char* const new_line = static_cast<const char*>(std::memchr(line_begin, '\n', m_buffer_end - line_begin));
+            m_line_end = new_line != nullptr ? new_line : m_buffer_end;
+            m_next_line = new_line != nullptr ? new_line + 1 : m_buffer_end;
+
+            if (m_line_end != line_begin && m_line_end[-1] == '\r')
+                --m_line_end;
+
+            if (m_line_end != line_begin) {
+                m_next_field = line_begin;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @return whether the current line has more fields
+     */
+    bool hasNextField() const {return m_next_field != nullptr;}
+
+    /**
+     * @return the next field of the current line
+     * @throws std::runtime_error in case the line has no more fields
+     */
+    Field nextField() {
+        if (m_next_field == nullptr)
+            throw std::runtime_error("missing field in csv line");
+
+        const char* const comma = static_cast<const char*>(std::memchr(m_next_field, ',', m_line_end - m_next_field));
+        const Field field = {m_next_field, comma != nullptr ? comma : m_line_end};
+        m_next_field = comma != nullptr ? comma + 1 : nullptr;
+
+        return field;
+    }
+
+    /**
+     * @return the next field of the current line parsed as an integer, see parseInt
+     */
+    long long nextInt() {return parseInt(nextField());}
+
+    /**
+     * skips fields of the current line
+     * @param num_fields - num of fields to skip
+     */
+    void skipFields(const int num_fields) {
+        for (int i = 0; i < num_fields; ++i)
+            nextField();
+    }
+
+    /**
+     * parses a decimal integer, leading spaces and anything after the digits are ignored (like std::stoll)
+     * @param field - a field
+     * @return the integer
+     * @throws std::runtime_error in case the field does not start with an integer
+     */
+    static long long parseInt(const Field& field) {
+        const char* it = field.begin;
+        while (it != field.end && *it == ' ')
+            ++it;
+
+        const bool is_negative = it != field.end && *it == '-';
+        if (is_negative)
+            ++it;
+
+        if (it == field.end || !isDigit(*it))
+            throw std::runtime_error("expected an integer csv field, got '" + field.toString() + "'");
+
+        long long value = 0;
+        for (; it != field.end && isDigit(*it); ++it)
+            value = value * 10 + (*it - '0');
+
+        return is_negative ? -value : value;
+    }
+
+private:
+    static bool isDigit(const char c) {return c >= '0' && c <= '9';}
+
+// m_buffer_end - one past the last byte of the buffer
+// m_next_line - first byte of the line after the current line
+// m_line_end - one past the last byte of the current line (excluding "\r\n")
+// m_next_field - first byte of the next field of the current line, null in case there are no more fields
+private:
+    const char* const m_buffer_end;
+    const char* m_next_line;
+    const char* m_line_end;
+    const char* m_next_field;
+};
@@ -0,0 +1,121 @@
+#include "DissimilaritiesMatrix.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+const std::string DissimilaritiesMatrix::IN_MEMORY = "";
+constexpr uint16_t DissimilaritiesMatrix::MAX_UINT16_DISTANCE;
+
+std::unique_ptr<DissimilaritiesMatrix> DissimilaritiesMatrix::create(const std::string& storage_dir,
+                                                                     const Precision precision){
+    if (storage_dir == IN_MEMORY)
+        return std::make_unique<InMemoryDissimilaritiesMatrix>(precision);
+
+    return std::make_unique<MappedDissimilaritiesMatrix>(storage_dir, precision);
+}
+
+DissimilaritiesMatrix::Precision DissimilaritiesMatrix::getPrecision(const std::string& precision){
+    if (precision == "float32")
+        return Precision::FLOAT32;
+    if (precision == "uint16")
+        return Precision::UINT16;
+
+    throw std::invalid_argument("unknown dissimilarities precision: " + precision + " (should be float32 or uint16)");
+}
+
+std::string DissimilaritiesMatrix::getPrecisionName(const Precision precision){
+    return precision == Precision::UINT16 ? "uint16" : "float32";
+}
+
+void InMemoryDissimilaritiesMatrix::resize(const int num_rows){
+    // the rows of a lower triangle do not grow, only the new rows are allocated
+    const int num_old_rows = m_cells.size();
+    m_cells.resize(num_rows);
+    m_rows.resize(num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+        if (i >= num_old_rows)
+            m_cells[i].resize((i + 1) * m_cell_size);
+
+        m_rows[i] = m_cells[i].data();
+    }
+}
+
+MappedDissimilaritiesMatrix::MappedDissimilaritiesMatrix(const std::string& storage_dir, const Precision precision) :
+        DissimilaritiesMatrix(precision, false), m_storage_dir(storage_dir), m_fd(-1), m_data(nullptr), m_capacity(0), m_mapping_size(0)
+{
+    // fail early in case the file can not be created
+    resize(0);
+}
+
+MappedDissimilaritiesMatrix::~MappedDissimilaritiesMatrix(){
+    unmap();
+}
+
+void MappedDissimilaritiesMatrix::unmap(){
+    if (m_data != nullptr)
+        munmap(m_data, m_mapping_size);
+    if (m_fd >= 0)
+        close(m_fd);
+
+    m_data = nullptr;
+    m_fd = -1;
+}
+
+void MappedDissimilaritiesMatrix::resize(const int num_rows){
+    const int num_old_rows = m_rows.size();
+    if (m_fd < 0 || num_rows > m_capacity) {
+        // the capacity grows by half at least, so the rows are copied to a new file only a few times
+        static constexpr int MIN_CAPACITY = 1024;
+        const int capacity = std::max({num_rows, m_capacity + m_capacity / 2, MIN_CAPACITY});
+        const size_t mapping_size = static_cast<size_t>(capacity) * capacity * m_cell_size;
+
+        std::string path = m_storage_dir + "/dissimilarities_matrix_XXXXXX";
+        const int fd = mkstemp(&path[0]);
+        if (fd < 0)
+            throw std::runtime_error("could not create a dissimilarities matrix file in " + m_storage_dir);
+
+        // the file is removed right away, its space is freed once it is closed
+        unlink(path.c_str());
+        if (ftruncate(fd, mapping_size) != 0) {
+            close(fd);
+            throw std::runtime_error("could not allocate a dissimilarities matrix file of " +
+                                     std::to_string(mapping_size) + " bytes in " + m_storage_dir);
+        }
+
+        void* const data = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("could not map a dissimilarities matrix file in " + m_storage_dir);
+        }
+
+        unsigned char* const cells = static_cast<unsigned char*>(data);
+        for (int i = 0; i < num_old_rows; ++i)
+            std::memcpy(cells + static_cast<size_t>(i) * capacity * m_cell_size, m_rows[i], num_old_rows * m_cell_size);
+
+        unmap();
+        m_fd = fd;
+        m_data = cells;
+        m_capacity = capacity;
+        m_mapping_size = mapping_size;
+    }
+
+    m_rows.resize(num_rows);
+    for (int i = 0; i < num_rows; ++i)
+        m_rows[i] = m_data + static_cast<size_t>(i) * m_capacity * m_cell_size;
+}
+
+void MappedDissimilaritiesMatrix::prefetchRows(const int first_row, const int last_row) const{
+    if (first_row >= last_row)
+        return;
+
+    // madvise takes a range which starts at a page
+    static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(m_rows[first_row]) & ~(page_size - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(m_rows[last_row - 1] + m_rows.size() * m_cell_size);
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * DissimilarityCell struct - a cell value for each cell in dissimilarity matrix.
+ * the size two clusters hold from every origin cluster is the sum of their own sizes (see
+ * AlgorithmDSManager::getFileSizeFromOriginClusters), so it is not kept per cell
+ */
+struct DissimilarityCell {
+    DissimilarityCell() : jaccard_distance(0)
+    {
+    }
+
+    DissimilarityCell(const double jaccard_distance) :
+    jaccard_distance(jaccard_distance)
+    {
+    }
+
+    double jaccard_distance;
+};
+
+/**
+ * the storage of a symmetric dissimilarities matrix of jaccard distances. a cell whose distance is above 1 is a
+ * deactivated cell (DBL_MAX). the cells are kept in a lower triangle (a pair's cell is in the row of its larger index)
+ * or in both triangles (every row holds all the cells of its file, so a row is scanned in place), and their distances
+ * are kept as float32, or quantized to uint16 (1 / MAX_UINT16_DISTANCE steps). the jaccard distances are calculated as
+ * float32 (see BitMatrix::getJaccardDistance), so float32 keeps them exactly.
+ * the cells are reached through the rows' pointers, which the storage refreshes on every resize, so reading a cell
+ * costs the same for every storage
+ */
+class DissimilaritiesMatrix {
+public:
+    enum class Precision {
+        FLOAT32,
+        UINT16,
+    };
+
+    // the storage dir for keeping the matrix in memory
+    static const std::string IN_MEMORY;
+
+    // the uint16 code of distance 1, a code is the distance in steps of 1 / MAX_UINT16_DISTANCE
+    static constexpr uint16_t MAX_UINT16_DISTANCE = UINT16_MAX - 1;
+
+public:
+    /**
+     * @param storage_dir - directory of the matrix's file, IN_MEMORY to keep the matrix in memory
+     * @param precision - the precision of the cells' distances
+     * @return an empty matrix, kept in memory as a lower triangle or in a memory mapped file in storage_dir in both
+     * triangles
+     * @throws std::runtime_error in case the matrix's file could not be created
+     */
+    static std::unique_ptr<DissimilaritiesMatrix> create(const std::string& storage_dir, const Precision precision);
+
+    /**
+     * @param precision - precision's name, as given by command line (float32, uint16)
+     * @return the precision of the given name
+     * @throws std::invalid_argument in case there is no such precision
+     */
+    static Precision getPrecision(const std::string& precision);
+
+    /**
+     * @param precision - a precision
+     * @return the precision's name
+     */
+    static std::string getPrecisionName(const Precision precision);
+
+    DissimilaritiesMatrix(const DissimilaritiesMatrix&) = delete;
+    DissimilaritiesMatrix& operator=(const DissimilaritiesMatrix&) = delete;
+    virtual ~DissimilaritiesMatrix() = default;
+
+public:
+    /**
+     * @return num of rows (and of columns) of the matrix
+     */
+    int getNumberOfRows() const {return m_rows.size();}
+
+    /**
+     * @return the precision of the cells' distances
+     */
+    Precision getPrecision() const {return m_precision;}
+
+    /**
+     * @param row - a row index
+     * @param column - a column index
+     * @return the cell of the given pair
+     */
+    DissimilarityCell getCell(int row, int column) const{
+        if (m_is_lower_triangle && row < column)
+            std::swap(row, column);
+
+        const unsigned char* const cell = m_rows[row] + static_cast<size_t>(column) * m_cell_size;
+        if (m_precision == Precision::UINT16) {
+            uint16_t code;
+            std::memcpy(&code, cell, sizeof(code));
+            return {code > MAX_UINT16_DISTANCE ? DBL_MAX : code * (1.0 / MAX_UINT16_DISTANCE)};
+        }
+
+        float distance;
+        std::memcpy(&distance, cell, sizeof(distance));
+        return {distance == FLT_MAX ? DBL_MAX : distance};
+    }
+
+    /**
+     * sets the cell of the given pair (both of its cells in case both triangles are kept)
+     * @param row - a row index
+     * @param column - a column index
+     * @param cell - the cell's new value
+     */
+    void setCell(const int row, const int column, const DissimilarityCell& cell){
+        if (!m_is_lower_triangle || row >= column)
+            setCellInRow(row, column, cell.jaccard_distance);
+        if (!m_is_lower_triangle || row < column)
+            setCellInRow(column, row, cell.jaccard_distance);
+    }
+
+    /**
+     * grows the matrix to num_rows x num_rows cells, the existing cells keep their values and the new ones are 0
+     * @param num_rows - the new num of rows, not less than the current one
+     */
+    virtual void resize(const int num_rows) = 0;
+
+    /**
+     * hints that the given rows are about to be read, so their cells can be fetched ahead of the reader
+     * @param first_row - first row to fetch
+     * @param last_row - one past the last row to fetch
+     */
+    virtual void prefetchRows(const int first_row, const int last_row) const = 0;
+
+protected:
+    /**
+     * @param precision - the precision of the cells' distances
+     * @param is_lower_triangle - whether only the lower triangle is kept (row i has i + 1 cells)
+     */
+    DissimilaritiesMatrix(const Precision precision, const bool is_lower_triangle) :
+            m_precision(precision), m_is_lower_triangle(is_lower_triangle),
+            m_cell_size(precision == Precision::UINT16 ? sizeof(uint16_t) : sizeof(float)) {}
+
+private:
+    /**
+     * writes the given distance to a single cell
+     */
+    void setCellInRow(const int row, const int column, const double distance){
+        unsigned char* const cell = m_rows[row] + static_cast<size_t>(column) * m_cell_size;
+        if (m_precision == Precision::UINT16) {
+            const uint16_t code = distance > 1 ? UINT16_MAX :
+                                  static_cast<uint16_t>(distance * MAX_UINT16_DISTANCE + 0.5);
+            std::memcpy(cell, &code, sizeof(code));
+            return;
+        }
+
+        const float stored_distance = distance > 1 ? FLT_MAX : static_cast<float>(distance);
+        std::memcpy(cell, &stored_distance, sizeof(stored_distance));
+    }
+
+// m_precision - the precision of the cells' distances
+// m_is_lower_triangle - whether only the lower triangle is kept, both triangles are kept otherwise
+// m_cell_size - size of a cell in bytes
+// m_rows - per row, its first cell
+protected:
+    const Precision m_precision;
+    const bool m_is_lower_triangle;
+    const size_t m_cell_size;
+    std::vector<unsigned char*> m_rows;
+};
+
+/**
+ * a dissimilarities matrix whose lower triangle is kept in memory, row by row
+ */
+class InMemoryDissimilaritiesMatrix final : public DissimilaritiesMatrix {
+public:
+    /**
+     * @param precision - the precision of the cells' distances
+     */
+    explicit InMemoryDissimilaritiesMatrix(const Precision precision) : DissimilaritiesMatrix(precision, true) {}
+
+public:
+    void resize(const int num_rows) override;
+
+    void prefetchRows(const int, const int) const override {}
+
+// m_cells - per row, its cells
+private:
+    std::vector<std::vector<unsigned char>> m_cells;
+};
+
+/**
+ * a dissimilarities matrix in a memory mapped file, so only the rows in use are kept in memory and the kernel writes
+ * the rest back to the file. both triangles are kept, so a row is read from a single range of the file. the rows are
+ * laid out one after another with a fixed capacity, which grows (by copying the rows to a new file) only once the
+ * matrix outgrows it. the cells beyond the matrix's columns are never written, so they take no space in the file.
+ * the file is removed once it is created and lives as long as the matrix
+ */
+class MappedDissimilaritiesMatrix final : public DissimilaritiesMatrix {
+public:
+    /**
+     * @param storage_dir - directory of the matrix's file
+     * @param precision - the precision of the cells' distances
+     * @throws std::runtime_error in case the matrix's file could not be created
+     */
+    MappedDissimilaritiesMatrix(const std::string& storage_dir, const Precision precision);
+    ~MappedDissimilaritiesMatrix() override;
+
+public:
+    void resize(const int num_rows) override;
+
+    void prefetchRows(const int first_row, const int last_row) const override;
+
+private:
+    /**
+     * unmaps and closes the matrix's file (in case there is one)
+     */
+    void unmap();
+
+// m_storage_dir - directory of the matrix's file
+// m_fd - the matrix's file, -1 before the first resize
+// m_data - the mapped file, null before the first resize
+// m_capacity - num of cells in every row of the file (and num of rows the file has room for)
+// m_mapping_size - size of the file in bytes
+private:
+    const std::string m_storage_dir;
+    int m_fd;
+    unsigned char* m_data;
+    int m_capacity;
+    size_t m_mapping_size;
+};
@@ -0,0 +1,34 @@
+#include "FileBlocksIndex.hpp"
+
+void FileBlocksIndex::clear() {
+    m_appearances_matrix = nullptr;
+    m_num_blocks_in_file.clear();
+    m_first_block_offset.assign(1, 0);
+    m_blocks.clear();
+}
+
+void FileBlocksIndex::indexNewFiles(const BitMatrix& appearances_matrix) {
+    m_appearances_matrix = &appearances_matrix;
+
+    for (int file_index = getNumFiles(); file_index < appearances_matrix.getNumRows(); ++file_index) {
+        const std::vector<int> file_blocks = appearances_matrix.getSetColumns(file_index);
+        m_num_blocks_in_file.push_back(file_blocks.size());
+
+        // keep the blocks only in case they take less memory than the file's row (which is read instead otherwise)
+        const size_t row_bytes = static_cast<size_t>(appearances_matrix.getNumWordsInRow()) * sizeof(BitMatrix::Word);
+        if (file_blocks.size() * sizeof(int) <= row_bytes)
+            m_blocks.insert(m_blocks.end(), file_blocks.cbegin(), file_blocks.cend());
+
+        m_first_block_offset.push_back(m_blocks.size());
+    }
+}
+
+std::vector<int> FileBlocksIndex::getBlocksInFile(const int file_index) const {
+    std::vector<int> file_blocks;
+    file_blocks.reserve(m_num_blocks_in_file[file_index]);
+    forEachBlockInFile(file_index, [&file_blocks](const int block_index){
+        file_blocks.push_back(block_index);
+    });
+
+    return file_blocks;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "BitMatrix.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * index of the blocks of every file, alongside the appearances matrix (file x block).
+ * most files hold a tiny fraction of the blocks, so the sorted blocks of every such (sparse) file are kept one after
+ * the other in a compressed sparse row layout. files whose row in the appearances matrix is smaller than their list of
+ * blocks (dense files) are not kept in the list, their blocks are enumerated from the matrix's row
+ */
+class FileBlocksIndex final {
+public:
+    FileBlocksIndex() : m_appearances_matrix(nullptr), m_first_block_offset(1, 0) {}
+
+public:
+    /**
+     * removes all the files from the index
+     */
+    void clear();
+
+    /**
+     * indexes the rows of the given appearances matrix which were added since the last call (rows of files are never
+     * modified once they are indexed). the matrix is used by the index from now on, so it must outlive it
+     * @param appearances_matrix - the appearances matrix, row i is file i and column j is block j
+     */
+    void indexNewFiles(const BitMatrix& appearances_matrix);
+
+    /**
+     * @return num of indexed files
+     */
+    int getNumFiles() const {return m_num_blocks_in_file.size();}
+
+    /**
+     * @param file_index - an indexed file
+     * @return num of blocks in the file
+     */
+    int getNumBlocksInFile(const int file_index) const {return m_num_blocks_in_file[file_index];}
+
+    /**
+     * @param file_index - an indexed file
+     * @return the blocks of the file, in ascending order
+     */
+    std::vector<int> getBlocksInFile(const int file_index) const;
+
+    /**
+     * calls block_func(block) for every block of the file, in ascending order. the file's sorted blocks are used in
+     * case the file is sparse, otherwise its row of the appearances matrix is walked
+     * @param file_index - an indexed file
+     * @param block_func - callable which receives a block index
+     */
+    template<typename BlockFunc>
+    void forEachBlockInFile(const int file_index, BlockFunc block_func) const {
+        if (isFileSparse(file_index)) {
+            for (size_t offset = m_first_block_offset[file_index]; offset < m_first_block_offset[file_index + 1]; ++offset)
+                block_func(m_blocks[offset]);
+
+            return;
+        }
+
+        const BitMatrix::Word* row_words = m_appearances_matrix->getRow(file_index);
+        for (int word_index = 0; word_index < m_appearances_matrix->getNumWordsInRow(); ++word_index) {
+            for (BitMatrix::Word word = row_words[word_index]; word != 0; word &= word - 1)
+                block_func(word_index * BitMatrix::BITS_IN_WORD + __builtin_ctzll(word));
+        }
+    }
+
+private:
+    /**
+     * @param file_index - an indexed file
+     * @return whether the file's blocks are kept in m_blocks
+     */
+    bool isFileSparse(const int file_index) const {
+        return m_first_block_offset[file_index + 1] - m_first_block_offset[file_index] == m_num_blocks_in_file[file_index];
+    }
+
+// m_appearances_matrix - the indexed appearances matrix
+// m_num_blocks_in_file - file index to its num of blocks
+// m_first_block_offset - file index to the offset of its first block in m_blocks, with an extra last offset (the end
+//                        of the last file). a dense file has no blocks in m_blocks
+// m_blocks - the sorted blocks of every sparse file, file after file
+private:
+    const BitMatrix* m_appearances_matrix;
+    std::vector<int> m_num_blocks_in_file;
+    std::vector<size_t> m_first_block_offset;
+    std::vector<int> m_blocks;
+};
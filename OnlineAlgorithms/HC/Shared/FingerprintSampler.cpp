@@ -0,0 +1,46 @@
+#include "FingerprintSampler.hpp"
+
+#include <algorithm>
+
+constexpr int FingerprintSampler::NO_LIMIT;
+
+FingerprintSampler::FingerprintSampler(const int requested_num_fingerprints) :
+        m_requested_num_fingerprints(requested_num_fingerprints)
+{
+    if (requested_num_fingerprints != NO_LIMIT) {
+        m_heap.reserve(requested_num_fingerprints);
+        m_fingerprints.reserve(requested_num_fingerprints);
+    }
+}
+
+void FingerprintSampler::addCandidate(const uint64_t key, const int block_sn, const char* begin, const char* end){
+    if (m_requested_num_fingerprints == NO_LIMIT || m_heap.size() < m_requested_num_fingerprints) {
+        m_heap.push_back({key, block_sn, static_cast<int>(m_fingerprints.size())});
+        m_fingerprints.emplace_back(begin, end);
+        if (m_requested_num_fingerprints != NO_LIMIT)
+            std::push_heap(m_heap.begin(), m_heap.end());
+
+        return;
+    }
+
+    // replace the candidate with the largest key, in its slot
+    std::pop_heap(m_heap.begin(), m_heap.end());
+    const int slot = m_heap.back().slot;
+    m_fingerprints[slot].assign(begin, end);
+    m_heap.back() = {key, block_sn, slot};
+    std::push_heap(m_heap.begin(), m_heap.end());
+}
+
+std::vector<std::pair<int, std::string>> FingerprintSampler::getSelectedOrderedBySN() const {
+    std::vector<std::pair<int, std::string>> selected;
+    selected.reserve(m_heap.size());
+    for (const Candidate& candidate : m_heap)
+        selected.emplace_back(candidate.block_sn, m_fingerprints[candidate.slot]);
+
+    std::sort(selected.begin(), selected.end(),
+              [](const std::pair<int, std::string>& a, const std::pair<int, std::string>& b){
+        return a.first < b.first;
+    });
+
+    return selected;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * bottom-k sampling of the system's fingerprints (the min hash fingerprints used for clustering).
+ * every fingerprint gets a fixed 64-bit key and the k fingerprints with the smallest keys are selected, so the sample
+ * is deterministic across runs and does not depend on the order of the workloads. the candidates are kept in a max
+ * heap of integers, the fingerprint's string is copied only when it enters the heap (into the slot of the candidate
+ * it evicts)
+ */
+class FingerprintSampler final {
+public:
+    // the requested num of fingerprints for selecting all of them
+    static constexpr int NO_LIMIT = -1;
+
+public:
+    /**
+     * @param requested_num_fingerprints - num of fingerprints to select, NO_LIMIT for all
+     */
+    explicit FingerprintSampler(const int requested_num_fingerprints);
+
+public:
+    /**
+     * the key of a hex fingerprint (as written in the workloads) is its first 64 bits, so ordering by the key is
+     * ordering the fingerprints' strings lexicographically (a shorter fingerprint is left aligned, like a prefix).
+     * the digits are parsed without branches, chars which are not hex digits are mapped to some 4 bits as well
+     * @param begin - first char of the fingerprint, leading spaces are ignored
+     * @param end - one past the last char of the fingerprint
+     * @return the fingerprint's key
+     */
+    static uint64_t getFingerprintKey(const char* begin, const char* end) {
+        while (begin != end && *begin == ' ')
+            ++begin;
+
+        const uint64_t high_bits = parseHexDigits(begin, end);
+        return (high_bits << 32) | parseHexDigits(begin, end);
+    }
+
+    /**
+     * considers a fingerprint for the sample, every block should be given once
+     * @param block_sn - sn of the fingerprint's block
+     * @param begin - first char of the fingerprint
+     * @param end - one past the last char of the fingerprint
+     */
+    void addFingerprint(const int block_sn, const char* begin, const char* end) {
+        if (m_requested_num_fingerprints == NO_LIMIT) {
+            addCandidate(getFingerprintKey(begin, end), block_sn, begin, end);
+            return;
+        }
+
+        if (m_heap.size() < m_requested_num_fingerprints) {
+            addCandidate(getFingerprintKey(begin, end), block_sn, begin, end);
+            return;
+        }
+
+        // the heap is full, only a fingerprint below its max enters it. most fingerprints are rejected by their first
+        // digit or by the high half of their key, without parsing the rest of it
+        if (m_heap.empty())
+            return;
+
+        const char* digits = begin;
+        while (digits != end && *digits == ' ')
+            ++digits;
+
+        if (digits != end && getHexDigitValue(*digits) > (m_heap.front().key >> 60))
+            return;
+
+        const uint64_t high_bits = parseHexDigits(digits, end);
+        if (high_bits > (m_heap.front().key >> 32))
+            return;
+
+        const Candidate candidate = {(high_bits << 32) | parseHexDigits(digits, end), block_sn, 0};
+        if (candidate < m_heap.front())
+            addCandidate(candidate.key, block_sn, begin, end);
+    }
+
+    /**
+     * @return the sns of the selected fingerprints' blocks in ascending order, with the fingerprints' strings
+     */
+    std::vector<std::pair<int, std::string>> getSelectedOrderedBySN() const;
+
+private:
+    /**
+     * a selected fingerprint, its string is in m_fingerprints[slot]
+     */
+    struct Candidate {
+        uint64_t key;
+        int block_sn;
+        int slot;
+
+        bool operator<(const Candidate& other) const {
+            return key != other.key ? key < other.key : block_sn < other.block_sn;
+        }
+    };
+
+    /**
+     * parses the next (up to) 8 hex digits of a fingerprint into 32 bits, left aligned in case there are less digits
+     * @param it - the first digit to parse, moved past the parsed digits
+     * @param end - one past the last char of the fingerprint
+     * @return the parsed bits
+     */
+    static uint64_t parseHexDigits(const char*& it, const char* end) {
+        static const int HEX_DIGITS_IN_HALF_KEY = 8;
+        uint64_t bits = 0;
+        int num_digits = 0;
+        for (; it != end && num_digits < HEX_DIGITS_IN_HALF_KEY; ++it, ++num_digits)
+            bits = (bits << 4) | getHexDigitValue(*it);
+
+        return bits << (4 * (HEX_DIGITS_IN_HALF_KEY - num_digits));
+    }
+
+    /**
+     * @return the value (4 bits) of a hex digit, computed without branches
+     */
+    static uint64_t getHexDigitValue(const char digit) {
+        // '0'-'9' are 0x30-0x39 and 'a'-'f' ('A'-'F') are 0x61-0x66 (0x41-0x46), 9 is added to the latter
+        const uint64_t c = static_cast<unsigned char>(digit);
+        return ((c & 0xf) + 9 * ((c >> 6) & 1)) & 0xf;
+    }
+
+    /**
+     * adds the fingerprint to the heap, evicting the candidate with the largest key in case the heap is full
+     */
+    void addCandidate(const uint64_t key, const int block_sn, const char* begin, const char* end);
+
+// m_requested_num_fingerprints - num of fingerprints to select, NO_LIMIT for all
+// m_heap - max heap of the selected fingerprints so far (unordered in case of NO_LIMIT)
+// m_fingerprints - the strings of the selected fingerprints, by slot. a slot is reused by the candidate which evicts
+//                  its candidate, so its string's buffer is reused as well
+private:
+    const int m_requested_num_fingerprints;
+    std::vector<Candidate> m_heap;
+    std::vector<std::string> m_fingerprints;
+};
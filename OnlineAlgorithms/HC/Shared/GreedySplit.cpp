@@ -169,18 +169,18 @@ void GreedySplit::setReplicated(const AlgorithmDSManager &DSManager, const std::
     std::set<int> src_files = DSManager.getInitialClusteringAsVector()[transfer->src_vol_index];
     src_files.erase(transfer->file_index);
     std::set<int> src_blocks_after_transfer = VolumeCalcInfo::getBlocksInFiles(
-            DSManager.getAppearancesMatrix(),src_files);
+            DSManager.getFileBlocksIndex(),src_files);
     std::set<int> dst_block = VolumeCalcInfo::getBlocksInFiles(
-            DSManager.getAppearancesMatrix(),
+            DSManager.getFileBlocksIndex(),
             DSManager.getInitialClusteringAsVector()[transfer->dst_vol_index]);
-    std::set<int> file_blocks = VolumeCalcInfo::getBlocksInFile(DSManager.getAppearancesMatrix(),
+    std::set<int> file_blocks = VolumeCalcInfo::getBlocksInFile(DSManager.getFileBlocksIndex(),
                                                                transfer->file_index);
 
-    auto block_size_map = DSManager.getBlockToSizeMap();
+    const vector<int> &block_to_size_mapping = DSManager.getBlockToSize();
     long long int replicated = 0;
     for(const int& block: file_blocks){
         if(src_blocks_after_transfer.find(block) != src_blocks_after_transfer.cend() && dst_block.find(block) == dst_block.cend()){
-            replicated+= block_size_map[block];
+            replicated+= block_to_size_mapping[block];
         }
     }
 
@@ -206,7 +206,7 @@ map<string, set<int>> GreedySplit::doNaiveIter(
         valid_traffic_transfers.reserve(remaining_transfers.size());
 
         for (auto &transfer: remaining_transfers) {
-            const map<int, int> &block_to_size_mapping = DSManager.getBlockToSizeMap();
+            const vector<int> &block_to_size_mapping = DSManager.getBlockToSize();
 
             map<string, set<int>> final_state = iter_state;
 
@@ -223,7 +223,7 @@ map<string, set<int>> GreedySplit::doNaiveIter(
             transfer->end_iter_cost = Calculator::getClusteringCost(
                     false,
                     DONT_USE_CACHE,
-                    DSManager.getAppearancesMatrix(),
+                    DSManager.getFileBlocksIndex(),
                     block_to_size_mapping,
                     iter_state,
                     final_state,
@@ -290,7 +290,7 @@ map<string, set<int>> GreedySplit::doIter(const AlgorithmDSManager &DSManager, c
         valid_traffic_transfers.reserve(remaining_transfers.size());
 
         for (auto &transfer: remaining_transfers) {
-            const map<int, int> &block_to_size_mapping = DSManager.getBlockToSizeMap();
+            const vector<int> &block_to_size_mapping = DSManager.getBlockToSize();
 
             map<string, set<int>> final_state_without_removes = iter_state_without_removes;
             map<string, set<int>> final_state = iter_state;
@@ -310,7 +310,7 @@ map<string, set<int>> GreedySplit::doIter(const AlgorithmDSManager &DSManager, c
             transfer->middle_iter_cost = Calculator::getClusteringCost(
                     false,
                     DONT_USE_CACHE,
-                    DSManager.getAppearancesMatrix(),
+                    DSManager.getFileBlocksIndex(),
                     block_to_size_mapping,
                     iter_state_without_removes,
                     final_state_without_removes,
@@ -333,7 +333,7 @@ map<string, set<int>> GreedySplit::doIter(const AlgorithmDSManager &DSManager, c
             transfer->end_iter_cost = Calculator::getClusteringCost(
                     false,
                     DONT_USE_CACHE,
-                    DSManager.getAppearancesMatrix(),
+                    DSManager.getFileBlocksIndex(),
                     block_to_size_mapping,
                     iter_state,
                     final_state,
@@ -0,0 +1,253 @@
+#include "IngestionSnapshot.hpp"
+#include "MappedFile.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+constexpr uint32_t IngestionSnapshot::FORMAT_VERSION;
+
+namespace {
+    const char SNAPSHOT_MAGIC[8] = {'H', 'C', 'S', 'N', 'A', 'P', '\0', '\0'};
+
+    // identifies the contents of a workload, its snapshot is stale once it changes
+    struct WorkloadStamp {
+        uint64_t size;
+        int64_t modification_time_ns;
+    };
+
+    WorkloadStamp getWorkloadStamp(const std::string& workload_path){
+        struct stat workload_stat{};
+        if (stat(workload_path.c_str(), &workload_stat) != 0)
+            throw std::runtime_error("could not stat " + workload_path);
+
+        return {static_cast<uint64_t>(workload_stat.st_size),
+                static_cast<int64_t>(workload_stat.st_mtim.tv_sec) * 1000000000LL + workload_stat.st_mtim.tv_nsec};
+    }
+
+    // 64-bit FNV-1a
+    uint64_t hashBytes(uint64_t hash, const void* data, const size_t size){
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ULL;
+        }
+
+        return hash;
+    }
+
+    template<typename T>
+    void writeValue(std::ostream& out, const T& value){
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(std::ostream& out, const std::string& str){
+        writeValue<uint64_t>(out, str.size());
+        out.write(str.data(), str.size());
+    }
+
+    template<typename T>
+    void writeVector(std::ostream& out, const std::vector<T>& values){
+        writeValue<uint64_t>(out, values.size());
+        out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    void writeStrings(std::ostream& out, const std::vector<std::string>& strings){
+        writeValue<uint64_t>(out, strings.size());
+        for (const std::string& str : strings)
+            writeString(out, str);
+    }
+
+    /**
+     * reads the values written by the write functions above from a buffer
+     */
+    class SnapshotReader final {
+    public:
+        SnapshotReader(const char* begin, const char* end) : m_position(begin), m_end(end) {}
+
+        bool isAtEnd() const {return m_position == m_end;}
+
+        void readBytes(void* destination, const size_t size){
+            if (size > static_cast<size_t>(m_end - m_position))
+                throw std::runtime_error("truncated snapshot");
+
+            std::memcpy(destination, m_position, size);
+            m_position += size;
+        }
+
+        template<typename T>
+        T readValue(){
+            T value;
+            readBytes(&value, sizeof(T));
+            return value;
+        }
+
+        std::string readString(){
+            const uint64_t size = readValue<uint64_t>();
+            checkRemaining(size);
+            std::string str(m_position, size);
+            m_position += size;
+            return str;
+        }
+
+        template<typename T>
+        std::vector<T> readVector(){
+            const uint64_t size = readValue<uint64_t>();
+            checkRemaining(size * sizeof(T));
+            std::vector<T> values(size);
+            readBytes(values.data(), size * sizeof(T));
+            return values;
+        }
+
+        std::vector<std::string> readStrings(){
+            const uint64_t size = readValue<uint64_t>();
+            checkRemaining(size * sizeof(uint64_t));
+            std::vector<std::string> strings;
+            strings.reserve(size);
+            for (uint64_t i = 0; i < size; ++i)
+                strings.emplace_back(readString());
+
+            return strings;
+        }
+
+    private:
+        // fails before allocating in case a (corrupted) size is larger than the rest of the snapshot
+        void checkRemaining(const uint64_t size) const {
+            if (size > static_cast<uint64_t>(m_end - m_position))
+                throw std::runtime_error("truncated snapshot");
+        }
+
+    private:
+        const char* m_position;
+        const char* const m_end;
+    };
+
+    /**
+     * @return whether the header read from the reader matches the given key and the current workloads
+     */
+    bool isHeaderValid(SnapshotReader& reader, const IngestionSnapshot::Key& key){
+        char magic[sizeof(SNAPSHOT_MAGIC)];
+        reader.readBytes(magic, sizeof(magic));
+        if (std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+            reader.readValue<uint32_t>() != IngestionSnapshot::FORMAT_VERSION)
+            return false;
+
+        if (reader.readValue<uint64_t>() != key.workloads_paths.size())
+            return false;
+
+        for (const std::string& workload_path : key.workloads_paths) {
+            const WorkloadStamp stamp = getWorkloadStamp(workload_path);
+            if (reader.readString() != workload_path || reader.readValue<uint64_t>() != stamp.size ||
+                reader.readValue<int64_t>() != stamp.modification_time_ns)
+                return false;
+        }
+
+        return reader.readValue<int32_t>() == key.requested_number_of_fingerprints &&
+               reader.readValue<uint8_t>() == static_cast<uint8_t>(key.is_only_appearances_mat);
+    }
+}
+
+std::string IngestionSnapshot::getSnapshotPath(const std::string& snapshot_dir, const Key& key){
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = hashBytes(hash, &FORMAT_VERSION, sizeof(FORMAT_VERSION));
+    for (const std::string& workload_path : key.workloads_paths)
+        hash = hashBytes(hash, workload_path.c_str(), workload_path.size() + 1);
+    hash = hashBytes(hash, &key.requested_number_of_fingerprints, sizeof(key.requested_number_of_fingerprints));
+    hash = hashBytes(hash, &key.is_only_appearances_mat, sizeof(key.is_only_appearances_mat));
+
+    std::ostringstream snapshot_path;
+    snapshot_path << snapshot_dir << "/ingestion_" << std::hex << std::setw(16) << std::setfill('0') << hash
+                  << ".snapshot";
+    return snapshot_path.str();
+}
+
+bool IngestionSnapshot::load(const std::string& snapshot_path, const Key& key, Contents& contents,
+                             BitMatrix& appearances_matrix){
+    // a missing, stale, truncated or otherwise broken snapshot is not loaded (and is replaced by the caller)
+    try {
+        const MappedFile snapshot_file(snapshot_path);
+        SnapshotReader reader(snapshot_file.begin(), snapshot_file.end());
+        if (!isHeaderValid(reader, key))
+            return false;
+
+        const int num_files = reader.readValue<int32_t>();
+        const int num_fingerprints = reader.readValue<int32_t>();
+        const int num_words_in_row = reader.readValue<int32_t>();
+        if (num_files < 0 || num_fingerprints < 0)
+            return false;
+
+        appearances_matrix = BitMatrix(num_files, num_fingerprints);
+        if (appearances_matrix.getNumWordsInRow() != num_words_in_row)
+            return false;
+        reader.readBytes(appearances_matrix.getRow(0),
+                         static_cast<size_t>(num_files) * num_words_in_row * sizeof(BitMatrix::Word));
+
+        contents.file_workload_index = reader.readVector<int>();
+        contents.file_index_to_sn = reader.readVector<int>();
+        contents.file_index_to_input_file = reader.readStrings();
+        contents.file_to_size = reader.readVector<long long int>();
+        contents.fingerprints = reader.readStrings();
+        contents.fingerprint_to_size = reader.readVector<int>();
+        contents.initial_system_size_with_deduplication = reader.readValue<long long int>();
+        contents.optimal_system_size_with_deduplication = reader.readValue<long long int>();
+
+        for (const int workload_index : contents.file_workload_index) {
+            if (workload_index < 0 || workload_index >= key.workloads_paths.size())
+                return false;
+        }
+
+        return reader.isAtEnd() &&
+               contents.file_workload_index.size() == num_files && contents.file_index_to_sn.size() == num_files &&
+               contents.file_index_to_input_file.size() == num_files && contents.file_to_size.size() == num_files &&
+               contents.fingerprints.size() == num_fingerprints && contents.fingerprint_to_size.size() == num_fingerprints;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+void IngestionSnapshot::save(const std::string& snapshot_path, const Key& key, const Contents& contents,
+                             const BitMatrix& appearances_matrix){
+    const std::string temp_path = snapshot_path + ".tmp" + std::to_string(getpid());
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        throw std::runtime_error("could not create snapshot " + temp_path);
+
+    out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writeValue<uint32_t>(out, FORMAT_VERSION);
+    writeValue<uint64_t>(out, key.workloads_paths.size());
+    for (const std::string& workload_path : key.workloads_paths) {
+        const WorkloadStamp stamp = getWorkloadStamp(workload_path);
+        writeString(out, workload_path);
+        writeValue<uint64_t>(out, stamp.size);
+        writeValue<int64_t>(out, stamp.modification_time_ns);
+    }
+    writeValue<int32_t>(out, key.requested_number_of_fingerprints);
+    writeValue<uint8_t>(out, key.is_only_appearances_mat);
+
+    writeValue<int32_t>(out, appearances_matrix.getNumRows());
+    writeValue<int32_t>(out, appearances_matrix.getNumColumns());
+    writeValue<int32_t>(out, appearances_matrix.getNumWordsInRow());
+    out.write(reinterpret_cast<const char*>(appearances_matrix.getRow(0)),
+              static_cast<size_t>(appearances_matrix.getNumRows()) * appearances_matrix.getNumWordsInRow() *
+              sizeof(BitMatrix::Word));
+
+    writeVector(out, contents.file_workload_index);
+    writeVector(out, contents.file_index_to_sn);
+    writeStrings(out, contents.file_index_to_input_file);
+    writeVector(out, contents.file_to_size);
+    writeStrings(out, contents.fingerprints);
+    writeVector(out, contents.fingerprint_to_size);
+    writeValue<long long int>(out, contents.initial_system_size_with_deduplication);
+    writeValue<long long int>(out, contents.optimal_system_size_with_deduplication);
+
+    out.close();
+    if (!out || std::rename(temp_path.c_str(), snapshot_path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("could not write snapshot " + snapshot_path);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "BitMatrix.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * an on-disk snapshot of the state built by reading the workloads (the selected fingerprints, the sizes, the file
+ * index mappings and the appearances matrix), so later runs over the same inputs skip the reading.
+ * a snapshot is keyed by the workloads' paths, the requested num of fingerprints and the ingestion mode, and holds the
+ * size and modification time of every workload - it is used only while all of them match
+ */
+class IngestionSnapshot final {
+public:
+    // the version of the snapshot's format, snapshots of other versions are ignored
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * the inputs a snapshot is built from
+     */
+    struct Key {
+        std::vector<std::string> workloads_paths;
+        int requested_number_of_fingerprints;
+        bool is_only_appearances_mat;
+    };
+
+    /**
+     * the snapshot's state (besides the appearances matrix). files and fingerprints are given by their algo index
+     */
+    struct Contents {
+        // file to the index of its workload (in Key::workloads_paths)
+        std::vector<int> file_workload_index;
+        std::vector<int> file_index_to_sn;
+        std::vector<std::string> file_index_to_input_file;
+        std::vector<long long int> file_to_size;
+        // fingerprint to its fingerprint string (as read from the workloads)
+        std::vector<std::string> fingerprints;
+        std::vector<int> fingerprint_to_size;
+        long long int initial_system_size_with_deduplication = 0;
+        long long int optimal_system_size_with_deduplication = 0;
+    };
+
+public:
+    /**
+     * @param snapshot_dir - directory of the snapshots
+     * @param key - the snapshot's inputs
+     * @return the path of the snapshot of the given inputs
+     */
+    static std::string getSnapshotPath(const std::string& snapshot_dir, const Key& key);
+
+    /**
+     * loads the snapshot in the given path (through a memory mapping), in case it exists and is valid for the given
+     * inputs: same format version, same key and the workloads were not modified since it was saved
+     * @param snapshot_path - path of the snapshot
+     * @param key - the snapshot's inputs
+     * @param contents - filled with the snapshot's state
+     * @param appearances_matrix - filled with the snapshot's appearances matrix
+     * @return whether the snapshot was loaded (contents and appearances_matrix are not valid otherwise)
+     */
+    static bool load(const std::string& snapshot_path, const Key& key, Contents& contents,
+                     BitMatrix& appearances_matrix);
+
+    /**
+     * saves a snapshot to the given path. the snapshot is written to a temporary file which replaces the path once it
+     * is complete, so concurrent runs never read a partial snapshot
+     * @param snapshot_path - path of the snapshot
+     * @param key - the snapshot's inputs
+     * @param contents - the state to save
+     * @param appearances_matrix - the appearances matrix to save
+     * @throws std::runtime_error in case the snapshot could not be written
+     */
+    static void save(const std::string& snapshot_path, const Key& key, const Contents& contents,
+                     const BitMatrix& appearances_matrix);
+};
@@ -0,0 +1,39 @@
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdexcept>
+
+MappedFile::MappedFile(const std::string& path) : m_data(nullptr), m_size(0) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("could not open " + path);
+
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        throw std::runtime_error("could not stat " + path);
+    }
+
+    m_size = file_stat.st_size;
+    if (m_size > 0) {
+        void* const data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("could not map " + path);
+        }
+
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(data);
+    }
+
+    // the mapping stays valid after the file is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data != nullptr)
+        munmap(const_cast<char*>(m_data), m_size);
+}
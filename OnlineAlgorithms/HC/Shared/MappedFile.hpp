@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * a read only memory mapping of a whole file, which is unmapped once the object is destroyed.
+ * the file is mapped for a sequential read, so the kernel reads ahead of the reader
+ */
+class MappedFile final {
+public:
+    /**
+     * maps the given file
+     * @param path - path of the file
+     * @throws std::runtime_error in case the file could not be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+    /**
+     * @return the first byte of the file (the file's contents are not null terminated)
+     */
+    const char* begin() const {return m_data;}
+
+    /**
+     * @return one past the last byte of the file
+     */
+    const char* end() const {return m_data + m_size;}
+
+// m_data - the mapped contents of the file, null for an empty file
+// m_size - size of the file in bytes
+private:
+    const char* m_data;
+    size_t m_size;
+};
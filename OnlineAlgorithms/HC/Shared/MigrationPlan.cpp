@@ -191,12 +191,12 @@ shared_ptr<Calculator::CostResult> MigrationPlan::getCurrentIterCost() const{
         throw runtime_error("MigrationPlan::get_current_iter_cost: Out of bound");
 
     static const bool dont_validate_results = true;
-    const map<int, int>& block_to_size_mapping = m_ds->getBlockToSizeMap();
+    const vector<int> &block_to_size_mapping = m_ds->getBlockToSize();
 
     // use the "don't validate result" so all iteration's params are not needed
     return Calculator::getClusteringCost(false,
                                          m_use_cache,
-                                         m_ds->getAppearancesMatrix(),
+                                         m_ds->getFileBlocksIndex(),
                                          block_to_size_mapping,
                                          m_current_initial_system_clustering,
                                          m_current_final_system_clustering,
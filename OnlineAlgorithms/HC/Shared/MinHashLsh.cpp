@@ -0,0 +1,93 @@
+#include "MinHashLsh.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+    // splitmix64 finalizer, a cheap mix with full avalanche
+    uint64_t mix64(uint64_t value){
+        value += 0x9e3779b97f4a7c15ULL;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+}
+
+constexpr int MinHashLsh::MAX_BUCKET_PAIRS;
+
+MinHashLsh::MinHashLsh(const int num_bands, const int rows_per_band) :
+        m_num_bands(num_bands),
+        m_rows_per_band(rows_per_band)
+{
+    if (num_bands < 1 || rows_per_band < 1)
+        throw std::invalid_argument("LSH num of bands and rows per band should be at least 1. bands=" +
+                                    std::to_string(num_bands) + ", rows per band=" + std::to_string(rows_per_band));
+}
+
+uint32_t MinHashLsh::hashColumn(const int column, const int hash_index){
+    return static_cast<uint32_t>(mix64((static_cast<uint64_t>(hash_index) << 32) | static_cast<uint32_t>(column)) >> 32);
+}
+
+MinHashLsh::Signature MinHashLsh::getSignature(const std::vector<int>& set_columns) const{
+    if (set_columns.empty())
+        return {};
+
+    Signature signature(m_num_bands * m_rows_per_band, std::numeric_limits<uint32_t>::max());
+    for (const int column : set_columns) {
+        for (int hash_index = 0; hash_index < signature.size(); ++hash_index)
+            signature[hash_index] = std::min(signature[hash_index], hashColumn(column, hash_index));
+    }
+
+    return signature;
+}
+
+uint64_t MinHashLsh::getBandKey(const Signature& signature, const int band) const{
+    // keys of different bands never meet, so equal keys of different band contents are the only collisions (which
+    // only add a candidate pair)
+    uint64_t band_key = mix64(band);
+    for (int row = 0; row < m_rows_per_band; ++row)
+        band_key = mix64(band_key ^ signature[band * m_rows_per_band + row]);
+
+    return band_key;
+}
+
+std::vector<std::vector<int>> MinHashLsh::getCandidatePairs(const std::vector<Signature>& signatures,
+                                                            const std::set<int>& excluded_files) const{
+    std::vector<std::vector<int>> candidates(signatures.size());
+
+    // (band key, file), files with the same band key are in the same bucket once sorted
+    std::vector<std::pair<uint64_t, int>> band_keys;
+    band_keys.reserve(signatures.size());
+    for (int band = 0; band < m_num_bands; ++band) {
+        band_keys.clear();
+        for (int file = 0; file < signatures.size(); ++file) {
+            if (signatures[file].empty() || excluded_files.find(file) != excluded_files.cend())
+                continue;
+
+            band_keys.emplace_back(getBandKey(signatures[file], band), file);
+        }
+
+        std::sort(band_keys.begin(), band_keys.end());
+        for (int bucket_start = 0, bucket_end = 0; bucket_start < band_keys.size(); bucket_start = bucket_end) {
+            while (bucket_end < band_keys.size() && band_keys[bucket_end].first == band_keys[bucket_start].first)
+                ++bucket_end;
+
+            // the files in a bucket are in ascending order. every file is paired with at most the MAX_BUCKET_PAIRS
+            // files before it, so a hot bucket is linear in its size and its files are still chained together
+            for (int i = bucket_start + 1; i < bucket_end; ++i) {
+                for (int j = std::max(bucket_start, i - MAX_BUCKET_PAIRS); j < i; ++j)
+                    candidates[band_keys[i].second].push_back(band_keys[j].second);
+            }
+        }
+    }
+
+    for (auto& file_candidates : candidates) {
+        std::sort(file_candidates.begin(), file_candidates.end());
+        file_candidates.erase(std::unique(file_candidates.begin(), file_candidates.end()), file_candidates.end());
+    }
+
+    return candidates;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+/**
+ * MinHash signatures of sets of columns (the blocks of a file) and banded LSH over them.
+ * a signature has num_bands * rows_per_band min hashes, two files whose signatures are equal in all the rows of any
+ * band are a candidate pair. the probability of a pair with jaccard similarity s to be a candidate is
+ * 1 - (1 - s^rows_per_band)^num_bands
+ */
+class MinHashLsh final {
+public:
+    using Signature = std::vector<uint32_t>;
+
+public:
+    /**
+     * @param num_bands - num of bands, at least 1
+     * @param rows_per_band - num of min hashes in every band, at least 1
+     */
+    MinHashLsh(const int num_bands, const int rows_per_band);
+
+public:
+    int getNumBands() const {return m_num_bands;}
+    int getRowsPerBand() const {return m_rows_per_band;}
+
+    /**
+     * @param set_columns - the columns of the set
+     * @return the set's signature, empty in case the set is empty (an empty set is never a candidate)
+     */
+    Signature getSignature(const std::vector<int>& set_columns) const;
+
+    /**
+     * @param signature - a non empty signature
+     * @param band - a band index
+     * @return the key of the signature's bucket in the band, signatures with equal rows in the band have equal keys
+     */
+    uint64_t getBandKey(const Signature& signature, const int band) const;
+
+    /**
+     * @param signatures - signature per file
+     * @param excluded_files - files which are not part of any candidate pair
+     * @return per file i, the files j < i which are a candidate pair with it, in ascending order. in a bucket of over
+     * MAX_BUCKET_PAIRS files, a file is a candidate pair only with the MAX_BUCKET_PAIRS files before it in the bucket
+     */
+    std::vector<std::vector<int>> getCandidatePairs(const std::vector<Signature>& signatures,
+                                                    const std::set<int>& excluded_files) const;
+
+private:
+    // max num of candidate pairs a file takes from a single bucket
+    static constexpr int MAX_BUCKET_PAIRS = 64;
+
+private:
+    /**
+     * @param column - a column
+     * @param hash_index - index of the hash function in the signature
+     * @return the hash of the column by the given hash function
+     */
+    static uint32_t hashColumn(const int column, const int hash_index);
+
+// m_num_bands - num of bands
+// m_rows_per_band - num of min hashes in every band
+private:
+    const int m_num_bands;
+    const int m_rows_per_band;
+};
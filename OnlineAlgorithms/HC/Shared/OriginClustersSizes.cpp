@@ -0,0 +1,20 @@
+#include "OriginClustersSizes.hpp"
+
+OriginClustersSizes::OriginClustersSizes(std::initializer_list<std::pair<int, long long int>> clusters_sizes) :
+        OriginClustersSizes()
+{
+    for (const auto& cluster_size : clusters_sizes)
+        add(cluster_size.first, cluster_size.second);
+}
+
+OriginClustersSizes OriginClustersSizes::getMerged(const OriginClustersSizes& clusters_sizes1,
+                                                   const OriginClustersSizes& clusters_sizes2) {
+    OriginClustersSizes result;
+    result.m_present_clusters_mask = clusters_sizes1.m_present_clusters_mask | clusters_sizes2.m_present_clusters_mask;
+
+    // sizes of origin clusters which are not present are 0, so all of the origin clusters can be summed as is
+    for (int i = 0; i < MAX_ORIGIN_CLUSTERS; ++i)
+        result.m_sizes[i] = clusters_sizes1.m_sizes[i] + clusters_sizes2.m_sizes[i];
+
+    return result;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <initializer_list>
+
+/**
+ * the size (in bytes) a cluster holds from every origin cluster (initial volume).
+ * origin clusters are indexed [0, MAX_ORIGIN_CLUSTERS), the sizes are kept inline with a mask of the origin clusters
+ * which are present, so a present origin cluster may have a size of 0 (same as a key with value 0 in a map).
+ * copying and merging never allocate
+ */
+class OriginClustersSizes final {
+public:
+    // same as the max num of volumes supported by the cost's cache
+    static constexpr int MAX_ORIGIN_CLUSTERS = 20;
+
+public:
+    OriginClustersSizes() : m_present_clusters_mask(0), m_sizes() {}
+
+    /**
+     * @param clusters_sizes - list of (origin cluster, size) pairs, sizes of the same origin cluster are summed
+     */
+    OriginClustersSizes(std::initializer_list<std::pair<int, long long int>> clusters_sizes);
+
+public:
+    /**
+     * @return num of present origin clusters
+     */
+    int size() const {return __builtin_popcount(m_present_clusters_mask);}
+
+    /**
+     * @return whether the given origin cluster is present
+     */
+    bool contains(const int origin_cluster) const {return (m_present_clusters_mask >> origin_cluster) & 1;}
+
+    /**
+     * @return the size of the given origin cluster (0 in case it is not present)
+     */
+    long long int getSize(const int origin_cluster) const {return m_sizes[origin_cluster];}
+
+    /**
+     * @return mask of the present origin clusters, bit i is set if origin cluster i is present
+     */
+    uint32_t getPresentClustersMask() const {return m_present_clusters_mask;}
+
+    /**
+     * adds the given size to the origin cluster, the origin cluster is present from now on
+     * @param origin_cluster - an origin cluster index
+     * @param size - size to add
+     */
+    void add(const int origin_cluster, const long long int size) {
+        m_present_clusters_mask |= uint32_t(1) << origin_cluster;
+        m_sizes[origin_cluster] += size;
+    }
+
+    /**
+     * @param clusters_sizes1 - sizes of a cluster
+     * @param clusters_sizes2 - sizes of a cluster
+     * @return the sizes of the union of the clusters, every origin cluster which is present in any of them is present
+     */
+    static OriginClustersSizes getMerged(const OriginClustersSizes& clusters_sizes1,
+                                         const OriginClustersSizes& clusters_sizes2);
+
+// m_present_clusters_mask - bit i is set if origin cluster i is present
+// m_sizes - size per origin cluster, 0 for origin clusters which are not present
+private:
+    uint32_t m_present_clusters_mask;
+    long long int m_sizes[MAX_ORIGIN_CLUSTERS];
+};
@@ -0,0 +1,44 @@
+#include "RandomGenerator.hpp"
+
+RandomGenerator::RandomGenerator(const unsigned int seed) :
+        m_state(),
+        m_front(STATE_SEPARATION),
+        m_rear(0)
+{
+    this->seed(seed);
+}
+
+void RandomGenerator::seed(const unsigned int seed) {
+    // glibc replaces a zero seed with 1
+    int32_t word = seed == 0 ? 1 : static_cast<int32_t>(seed);
+    m_state[0] = word;
+
+    // fill the table with a minimal standard LCG (16807 * x mod (2^31 - 1)) using Schrage's method
+    for (int i = 1; i < STATE_DEGREE; ++i) {
+        const int32_t hi = word / 127773;
+        const int32_t lo = word % 127773;
+        word = 16807 * lo - 2836 * hi;
+        if (word < 0)
+            word += 2147483647;
+
+        m_state[i] = word;
+    }
+
+    m_front = STATE_SEPARATION;
+    m_rear = 0;
+
+    // discard the first 10 * STATE_DEGREE values, as glibc does
+    static constexpr int NUM_DISCARDED_VALUES = 10 * STATE_DEGREE;
+    for (int i = 0; i < NUM_DISCARDED_VALUES; ++i)
+        next();
+}
+
+int RandomGenerator::next() {
+    const uint32_t value = static_cast<uint32_t>(m_state[m_front]) + static_cast<uint32_t>(m_state[m_rear]);
+    m_state[m_front] = static_cast<int32_t>(value);
+
+    m_front = (m_front + 1) % STATE_DEGREE;
+    m_rear = (m_rear + 1) % STATE_DEGREE;
+
+    return static_cast<int>(value >> 1);
+}
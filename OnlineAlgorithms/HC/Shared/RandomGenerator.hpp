@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * a self-contained pseudo random generator which produces the exact same sequence as glibc's srand()/rand()
+ * (the default additive feedback generator, TYPE_3).
+ * every clustering worker holds its own instance, so runs can be executed concurrently while still picking the same
+ * merge offers as a serial execution which uses srand(seed) and rand()
+ */
+class RandomGenerator final {
+public:
+    /**
+     * creates a new generator seeded with the given seed (same as calling srand(seed))
+     * @param seed - the seed to use
+     */
+    explicit RandomGenerator(const unsigned int seed = 1);
+
+    /**
+     * re-seeds the generator (same as calling srand(seed))
+     * @param seed - the seed to use
+     */
+    void seed(const unsigned int seed);
+
+    /**
+     * @return the next random value in [0, RAND_MAX] (same as calling rand())
+     */
+    int next();
+
+// m_state - the generator's state table
+// m_front - index of the front pointer in m_state
+// m_rear - index of the rear pointer in m_state
+private:
+    static constexpr int STATE_DEGREE = 31;
+    static constexpr int STATE_SEPARATION = 3;
+
+    int32_t m_state[STATE_DEGREE];
+    int m_front;
+    int m_rear;
+};
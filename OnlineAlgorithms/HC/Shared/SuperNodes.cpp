@@ -0,0 +1,216 @@
+#include "SuperNodes.hpp"
+#include "MinHashLsh.hpp"
+#include "Utility.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <unordered_map>
+
+constexpr double SuperNodes::BY_HOST;
+constexpr int SuperNodes::LSH_ROWS_PER_BAND;
+constexpr int SuperNodes::MAX_LSH_BANDS;
+constexpr double SuperNodes::MIN_CANDIDATE_PROBABILITY;
+constexpr int SuperNodes::MAX_BUCKET_SIZE;
+
+SuperNodes::SuperNodes(const AlgorithmDSManager& ds, const double jaccard_threshold, const int min_num_super_nodes,
+                       const int num_threads) :
+        m_ds_version(ds.getVersion())
+{
+    const auto start_time = std::chrono::high_resolution_clock::now();
+
+    m_files = jaccard_threshold == BY_HOST ? groupByHost(ds) :
+              groupByJaccardThreshold(ds, jaccard_threshold, num_threads);
+    splitLargestSuperNodes(m_files, min_num_super_nodes);
+    const auto grouping_time = std::chrono::high_resolution_clock::now() - start_time;
+
+    const int num_super_nodes = m_files.size();
+    const BitMatrix& appearances_matrix = ds.getAppearancesMatrix();
+    m_blocks = BitMatrix(num_super_nodes, appearances_matrix.getNumColumns());
+    m_sizes.resize(num_super_nodes);
+    m_size_from_origin_clusters.resize(num_super_nodes);
+    for (int i = 0; i < num_super_nodes; ++i) {
+        for (const int file_index : m_files[i]) {
+            m_blocks.orRow(i, appearances_matrix, file_index);
+            m_size_from_origin_clusters[i] = OriginClustersSizes::getMerged(m_size_from_origin_clusters[i],
+                                                                            ds.getFileSizeFromOriginClusters(file_index));
+        }
+
+        m_sizes[i] = m_blocks.getIntersectionWeight(i, i, [&ds](const int fp_index){
+            return ds.getFingerprintSize(fp_index);
+        });
+    }
+
+    // every row is written by a single worker
+    m_dissimilarities_matrix.resize(num_super_nodes);
+    Utility::runInParallel(num_super_nodes, num_threads, [this](const int i, const int){
+        m_dissimilarities_matrix[i].resize(i + 1);
+        for (int j = 0; j < i; ++j)
+            m_dissimilarities_matrix[i][j] = {m_blocks.getJaccardDistance(i, j)};
+        m_dissimilarities_matrix[i][i] = {0};
+    });
+
+    std::cout << "Finished building super nodes. files=" << ds.getNumberOfFilesForClustering()
+              << ", removed files=" << ds.getNumberOfRemovedFiles() << ", super nodes=" << num_super_nodes
+              << (jaccard_threshold == BY_HOST ? std::string(" (by host)") :
+                  " (jaccard threshold=" + Utility::getString(jaccard_threshold) + ")")
+              << ", threads=" << num_threads << ", grouping took="
+              << std::chrono::duration_cast<std::chrono::milliseconds>(grouping_time).count() << "ms, took="
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::high_resolution_clock::now() - start_time).count() << "ms" << std::endl;
+}
+
+std::vector<std::set<int>> SuperNodes::groupByHost(const AlgorithmDSManager& ds){
+    const std::vector<int> files_hosts = ds.getFilesHosts();
+
+    std::vector<std::set<int>> super_nodes;
+    std::map<int, int> host_to_super_node;
+    for (int file_index = 0; file_index < files_hosts.size(); ++file_index) {
+        if (ds.isFileRemoved(file_index))
+            continue;
+
+        // files without a host are not collapsed
+        const int host = files_hosts[file_index];
+        if (host == AlgorithmDSManager::NO_HOST) {
+            super_nodes.push_back({file_index});
+            continue;
+        }
+
+        const auto super_node_it = host_to_super_node.find(host);
+        if (super_node_it != host_to_super_node.cend()) {
+            super_nodes[super_node_it->second].insert(file_index);
+            continue;
+        }
+
+        host_to_super_node[host] = super_nodes.size();
+        super_nodes.push_back({file_index});
+    }
+
+    return super_nodes;
+}
+
+int SuperNodes::getNumberOfLshBands(const double jaccard_threshold){
+    // a pair of similarity s is a candidate pair with probability 1 - (1 - s^LSH_ROWS_PER_BAND)^num_bands
+    const double min_band_probability = std::pow(1 - jaccard_threshold, LSH_ROWS_PER_BAND);
+    if (min_band_probability >= 1)
+        return 1;
+
+    const double num_bands = std::ceil(std::log(1 - MIN_CANDIDATE_PROBABILITY) / std::log(1 - min_band_probability));
+    return static_cast<int>(std::max(1.0, std::min<double>(MAX_LSH_BANDS, num_bands)));
+}
+
+std::vector<std::set<int>> SuperNodes::groupByJaccardThreshold(const AlgorithmDSManager& ds,
+                                                               const double jaccard_threshold, const int num_threads){
+    const int num_files = ds.getNumberOfFilesForClustering();
+
+    // the band keys of every file are calculated ahead, empty files have none
+    const MinHashLsh minhash_lsh(getNumberOfLshBands(jaccard_threshold), LSH_ROWS_PER_BAND);
+    const FileBlocksIndex& file_blocks_index = ds.getFileBlocksIndex();
+    std::vector<std::vector<uint64_t>> files_band_keys(num_files);
+    Utility::runInParallel(num_files, num_threads, [&](const int file_index, const int){
+        if (ds.isFileRemoved(file_index))
+            return;
+
+        const MinHashLsh::Signature signature = minhash_lsh.getSignature(file_blocks_index.getBlocksInFile(file_index));
+        if (signature.empty())
+            return;
+
+        files_band_keys[file_index].resize(minhash_lsh.getNumBands());
+        for (int band = 0; band < minhash_lsh.getNumBands(); ++band)
+            files_band_keys[file_index][band] = minhash_lsh.getBandKey(signature, band);
+    });
+
+    // per band, the super nodes (ascending) of every bucket. only the first file of a super node is in the buckets, so
+    // a file is compared only with the first files which share a bucket with it. a full bucket takes no more super
+    // nodes, so a hot bucket does not make every file compared with most of the super nodes
+    static constexpr int NO_SUPER_NODE = -1;
+    std::vector<std::unordered_map<uint64_t, std::vector<int>>> bands_buckets(minhash_lsh.getNumBands());
+    const BitMatrix& appearances_matrix = ds.getAppearancesMatrix();
+    int empty_files_super_node = NO_SUPER_NODE;
+    std::vector<int> candidate_super_nodes;
+
+    std::vector<std::set<int>> super_nodes;
+    for (int file_index = 0; file_index < num_files; ++file_index) {
+        if (ds.isFileRemoved(file_index))
+            continue;
+
+        // empty files are within any threshold only from each other
+        const std::vector<uint64_t>& band_keys = files_band_keys[file_index];
+        if (band_keys.empty()) {
+            if (empty_files_super_node == NO_SUPER_NODE) {
+                empty_files_super_node = super_nodes.size();
+                super_nodes.emplace_back();
+            }
+
+            super_nodes[empty_files_super_node].insert(file_index);
+            continue;
+        }
+
+        candidate_super_nodes.clear();
+        for (int band = 0; band < band_keys.size(); ++band) {
+            const auto bucket_it = bands_buckets[band].find(band_keys[band]);
+            if (bucket_it != bands_buckets[band].cend())
+                candidate_super_nodes.insert(candidate_super_nodes.end(), bucket_it->second.cbegin(),
+                                             bucket_it->second.cend());
+        }
+        std::sort(candidate_super_nodes.begin(), candidate_super_nodes.end());
+        candidate_super_nodes.erase(std::unique(candidate_super_nodes.begin(), candidate_super_nodes.end()),
+                                    candidate_super_nodes.end());
+
+        // the first file of a super node is its smallest file
+        const auto super_node_it = std::find_if(candidate_super_nodes.cbegin(), candidate_super_nodes.cend(),
+                                                [&](const int super_node){
+            const int first_file = *super_nodes[super_node].cbegin();
+            return appearances_matrix.getJaccardDistance(file_index, first_file) <= jaccard_threshold;
+        });
+
+        if (super_node_it != candidate_super_nodes.cend()) {
+            super_nodes[*super_node_it].insert(file_index);
+            continue;
+        }
+
+        for (int band = 0; band < band_keys.size(); ++band) {
+            std::vector<int>& bucket = bands_buckets[band][band_keys[band]];
+            if (bucket.size() < MAX_BUCKET_SIZE)
+                bucket.push_back(super_nodes.size());
+        }
+        super_nodes.push_back({file_index});
+    }
+
+    return super_nodes;
+}
+
+void SuperNodes::splitLargestSuperNodes(std::vector<std::set<int>>& super_nodes, const int min_num_super_nodes){
+    if (super_nodes.size() >= min_num_super_nodes)
+        return;
+
+    // (num of files, super node), the super node with the most files is on top
+    std::priority_queue<std::pair<int, int>> super_nodes_by_num_files;
+    for (int super_node = 0; super_node < super_nodes.size(); ++super_node)
+        super_nodes_by_num_files.emplace(super_nodes[super_node].size(), super_node);
+
+    while (super_nodes.size() < min_num_super_nodes && !super_nodes_by_num_files.empty() &&
+           super_nodes_by_num_files.top().first > 1) {
+        const int super_node = super_nodes_by_num_files.top().second;
+        super_nodes_by_num_files.pop();
+
+        // the second half of the super node's files becomes a super node of its own
+        std::set<int>& files = super_nodes[super_node];
+        auto split_it = files.begin();
+        std::advance(split_it, files.size() / 2);
+        std::set<int> split_files(split_it, files.end());
+        files.erase(split_it, files.end());
+
+        super_nodes_by_num_files.emplace(files.size(), super_node);
+        super_nodes_by_num_files.emplace(split_files.size(), super_nodes.size());
+        super_nodes.push_back(std::move(split_files));
+    }
+
+    std::sort(super_nodes.begin(), super_nodes.end(), [](const std::set<int>& super_node1,
+                                                         const std::set<int>& super_node2){
+        return *super_node1.cbegin() < *super_node2.cbegin();
+    });
+}
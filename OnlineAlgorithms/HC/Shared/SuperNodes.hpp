@@ -0,0 +1,149 @@
+#pragma once
+
+#include "AlgorithmDSManager.hpp"
+#include "BitMatrix.hpp"
+#include "OriginClustersSizes.hpp"
+
+#include <set>
+#include <vector>
+
+/**
+ * the first level of a two level clustering: the files are collapsed into super nodes, and the hierarchical clustering
+ * runs over the super nodes instead of the files. a super node is taken as a single file with the blocks of all its
+ * files, so the dissimilarities matrix is of super nodes only (its size is the num of super nodes squared).
+ * the files are collapsed by their host (files without a host are super nodes of their own), or by a jaccard threshold:
+ * every file joins the first super node whose first file is within the threshold from it, and starts a new super node
+ * otherwise. the first files are found through MinHash LSH buckets, so a file is compared only with the first files
+ * which share a bucket with it, and may miss its super node with a probability of up to 1 - MIN_CANDIDATE_PROBABILITY
+ * (more for thresholds which need over MAX_LSH_BANDS bands, or once a bucket holds MAX_BUCKET_SIZE first files).
+ * the clustering ends with a cluster per workload, so the largest super nodes are split until there are at least that
+ * many super nodes (or a super node per file). removed files are not in any super node
+ */
+class SuperNodes final {
+public:
+    // the jaccard threshold for collapsing the files by their host
+    static constexpr double BY_HOST = -1;
+
+public:
+    /**
+     * collapses the current files of ds into super nodes
+     * @param ds - the DS manager of the files
+     * @param jaccard_threshold - max jaccard distance between a file and the first file of its super node (below 1),
+     *                            BY_HOST to collapse the files by their host
+     * @param min_num_super_nodes - min num of super nodes, as long as there are enough files
+     * @param num_threads - num of threads used to calculate the files' MinHash signatures and to build the
+     *                      dissimilarities matrix
+     */
+    SuperNodes(const AlgorithmDSManager& ds, const double jaccard_threshold, const int min_num_super_nodes,
+               const int num_threads);
+
+    SuperNodes(const SuperNodes&) = delete;
+    SuperNodes& operator=(const SuperNodes&) = delete;
+    ~SuperNodes() = default;
+
+public:
+    /**
+     * @return the version of the DS manager the super nodes were built from
+     */
+    int getDSVersion() const {return m_ds_version;}
+
+    /**
+     * @return num of super nodes
+     */
+    int getNumberOfSuperNodes() const {return m_files.size();}
+
+    /**
+     * @param super_node - a super node index
+     * @return the files (algo indices) of the super node
+     */
+    const std::set<int>& getFiles(const int super_node) const {return m_files[super_node];}
+
+    /**
+     * @param super_node - a super node index
+     * @return the size of the super node's blocks
+     */
+    double getSize(const int super_node) const {return m_sizes[super_node];}
+
+    /**
+     * @param super_node - a super node index
+     * @return the size the super node's files hold from their origin clusters
+     */
+    const OriginClustersSizes& getSizeFromOriginClusters(const int super_node) const{
+        return m_size_from_origin_clusters[super_node];
+    }
+
+    /**
+     * @return the blocks of every super node (row i is super node i, column j is fingerprint j)
+     */
+    const BitMatrix& getBlocks() const {return m_blocks;}
+
+    /**
+     * @param super_node1 - a super node index
+     * @param super_node2 - a super node index
+     * @return the dissimilarity cell between the super nodes
+     */
+    const AlgorithmDSManager::DissimilarityCell& getDissimilarityCell(const int super_node1,
+                                                                      const int super_node2) const{
+        // only the bottom triangle (with the diagonal) is kept
+        if (super_node1 < super_node2)
+            return m_dissimilarities_matrix[super_node2][super_node1];
+
+        return m_dissimilarities_matrix[super_node1][super_node2];
+    }
+
+private:
+    // num of min hashes in every LSH band of the jaccard threshold grouping
+    static constexpr int LSH_ROWS_PER_BAND = 4;
+    // max num of LSH bands of the jaccard threshold grouping
+    static constexpr int MAX_LSH_BANDS = 128;
+    // min probability of a file to share an LSH bucket with a first file which is within the threshold from it
+    static constexpr double MIN_CANDIDATE_PROBABILITY = 0.99;
+    // max num of first files in an LSH bucket of the jaccard threshold grouping, so a file is compared with at most
+    // MAX_BUCKET_SIZE first files per band
+    static constexpr int MAX_BUCKET_SIZE = 64;
+
+private:
+    /**
+     * @param ds - the DS manager of the files
+     * @return the super nodes of ds's files by their host, ordered by their first file
+     */
+    static std::vector<std::set<int>> groupByHost(const AlgorithmDSManager& ds);
+
+    /**
+     * @param ds - the DS manager of the files
+     * @param jaccard_threshold - max jaccard distance between a file and the first file of its super node
+     * @param num_threads - num of threads used to calculate the files' MinHash signatures
+     * @return the super nodes of ds's files by the jaccard threshold, ordered by their first file
+     */
+    static std::vector<std::set<int>> groupByJaccardThreshold(const AlgorithmDSManager& ds,
+                                                              const double jaccard_threshold, const int num_threads);
+
+    /**
+     * @param jaccard_threshold - max jaccard distance between a file and the first file of its super node, below 1
+     * @return the num of LSH bands (up to MAX_LSH_BANDS) for a file to share a bucket with a first file within the
+     *         threshold from it with a probability of at least MIN_CANDIDATE_PROBABILITY
+     */
+    static int getNumberOfLshBands(const double jaccard_threshold);
+
+    /**
+     * splits the super nodes with the most files in halves (by their files' order) until there are at least
+     * min_num_super_nodes super nodes, or every super node is of a single file
+     * @param super_nodes - the super nodes, ordered by their first file (and kept so)
+     * @param min_num_super_nodes - min num of super nodes
+     */
+    static void splitLargestSuperNodes(std::vector<std::set<int>>& super_nodes, const int min_num_super_nodes);
+
+// m_ds_version - the version of the DS manager the super nodes were built from
+// m_files - per super node, its files
+// m_sizes - per super node, the size of its blocks
+// m_size_from_origin_clusters - per super node, the size its files hold from their origin clusters
+// m_blocks - per super node, the union of its files' blocks
+// m_dissimilarities_matrix - the bottom triangle of the super nodes' dissimilarities matrix, row i has i + 1 cells
+private:
+    const int m_ds_version;
+    std::vector<std::set<int>> m_files;
+    std::vector<double> m_sizes;
+    std::vector<OriginClustersSizes> m_size_from_origin_clusters;
+    BitMatrix m_blocks;
+    std::vector<std::vector<AlgorithmDSManager::DissimilarityCell>> m_dissimilarities_matrix;
+};
@@ -11,31 +11,46 @@
 #include <unistd.h>
 #include <iostream>
 #include <fstream>
-
-std::map<int,long long int> Utility::getMergedMap(const std::map<int,long long int>& map1, const std::map<int,long long int>& map2,
-                                                  const std::map<int,long long int>& map_subtract){
-    std::map<int,long long int> result(map1);
-    for ( const auto &key_val : map2 ) {
-        auto res_find = result.find(key_val.first);
-        if(res_find == result.end()){
-            result[key_val.first] = key_val.second;
-        }
-        else{
-            result[key_val.first] += key_val.second;
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+void Utility::runInParallel(const int num_work_items, const int num_threads,
+                            const std::function<void(const int, const int)>& work_item_func){
+    const int num_workers = std::max(1, std::min(num_threads, num_work_items));
+
+    std::atomic<int> next_work_item(0);
+    std::exception_ptr first_exception = nullptr;
+    std::mutex exception_lock;
+
+    auto worker = [&](const int worker_index){
+        for (int work_item = next_work_item++; work_item < num_work_items; work_item = next_work_item++) {
+            try {
+                work_item_func(work_item, worker_index);
+            }catch (...){
+                std::lock_guard<std::mutex> guard(exception_lock);
+                if (first_exception == nullptr)
+                    first_exception = std::current_exception();
+
+                // stop handing out new work items
+                next_work_item = num_work_items;
+            }
         }
-    }
+    };
 
-    for ( const auto &key_val : map_subtract ) {
-        auto res_find = result.find(key_val.first);
-        if(res_find != result.end()){
-            result[key_val.first] -= key_val.second;
-        }
-        else{
-            throw std::runtime_error("should not arrive here");
-        }
-    }
+    // the calling thread is a worker as well
+    std::vector<std::thread> threads;
+    threads.reserve(num_workers);
+    for (int i = 1; i < num_workers; ++i)
+        threads.emplace_back(worker, i);
+
+    worker(0);
+
+    for (auto& t : threads)
+        t.join();
 
-    return std::move(result);
+    if (first_exception != nullptr)
+        std::rethrow_exception(first_exception);
 }
 
 int Utility::binarySearch(const std::vector<int>& array, int left_index, int right_index, int value) {
@@ -84,71 +99,6 @@ bool Utility::isFileExists(const std::string& path) {
     return (stat(path.c_str(), &buffer) == 0);
 }
 
-float Utility::getJaccardDistance(const std::vector<bool>& row1,const std::vector<bool>& row2) {
-    int co_absence = 0;
-    int xor_exists = 0;
-
-    for (int k = 0; k < row1.size(); ++k) {
-        co_absence += ((!row1[k]) && (!row2[k]))? 1 : 0;
-        xor_exists += (((!row1[k]) && (row2[k])) || ((row1[k]) && (!row2[k]))) ? 1: 0;
-    }
-
-    const int diff = row1.size() - co_absence;
-    // in case we divide by 0, set value to 0
-    if(diff == 0)
-        return 0;
-
-    return static_cast<float>(xor_exists) / static_cast<float>(diff);
-}
-
-bool Utility::isWorkloadBlockLine(const std::vector<std::string>& splitted_line_content){
-    static const std::string BLOCK_LINE_START_STRING = "B";
-    return splitted_line_content.front() == BLOCK_LINE_START_STRING;
-}
-
-bool Utility::isWorkloadFileLine(const std::vector<std::string>& splitted_line_content){
-    static const std::string FILE_LINE_START_STRING = "F";
-
-    return splitted_line_content.front() == FILE_LINE_START_STRING;
-}
-
-int Utility::getNumOfBlockInFile(const std::vector<std::string>& splitted_line_content) {
-    static constexpr int FILE_NUM_OF_BLOCKS_INDEX = 4;
-    return stoi(splitted_line_content[FILE_NUM_OF_BLOCKS_INDEX]);
-}
-
-std::string Utility::getInputFileOfFile(const std::vector<std::string>& splitted_line_content) {
-    static constexpr int INPUT_FILE_INDEX = 2;
-    return std::move(splitString(splitted_line_content[INPUT_FILE_INDEX], '_')[1]); // assumes fileId is <vol>_<inputFile>
-}
-
-int Utility::getBlockSNInFileByIndex(const std::vector<std::string>& splitted_line_content, const int block_index) {
-    static constexpr int FILE_RECIPE_BLOCK_SN_START_INDEX = 5;
-    static constexpr int BLOCK_SN_JUMP = 2;
-    return stoi(splitted_line_content[FILE_RECIPE_BLOCK_SN_START_INDEX + block_index * BLOCK_SN_JUMP]);
-}
-
-int Utility::getBlockSizeInFileByIndex(const std::vector<std::string>& splitted_line_content, const int block_index) {
-    static constexpr int FILE_RECIPE_BLOCK_SIZE_START_INDEX = 6;
-    static constexpr int BLOCK_SIZE_JUMP = 2;
-    return stoi(splitted_line_content[FILE_RECIPE_BLOCK_SIZE_START_INDEX + block_index * BLOCK_SIZE_JUMP]);
-}
-
-int Utility::getWorkloadBlockSN(const std::vector<std::string>& splitted_line_content) {
-    static constexpr int BLOCK_LINE_SN_INDEX = 1;
-    return stoi(splitted_line_content[BLOCK_LINE_SN_INDEX]);
-}
-
-const std::string& Utility::getWorkloadBlockFingerprint(const std::vector<std::string>& splitted_line_content) {
-    static constexpr int BLOCK_LINE_FP_INDEX = 2;
-    return splitted_line_content[BLOCK_LINE_FP_INDEX];
-}
-
-int Utility::getWorkloadFileSN(const std::vector<std::string>& splitted_line_content) {
-    static constexpr int FILE_LINE_SN_INDEX = 1;
-    return stoi(splitted_line_content[FILE_LINE_SN_INDEX]);
-}
-
 std::string Utility::getBaseName(const std::string &path) {
     // Find the last slash in the path
     size_t pos = path.find_last_of("/");
@@ -8,6 +8,8 @@
 #include <unordered_set>
 #include <set>
 #include <memory>
+#include <algorithm>
+#include <functional>
 
 namespace Utility {
     /**
@@ -68,79 +70,41 @@ namespace Utility {
     std::string getString(const double val);
 
     /**
-     *
-     * @param map1 - a map of int to int
-     * @param map2 - a map of int to int
-     * @param map_subtract - a map of int to int to subtract (duplicated)
-     * @return the merged map of map 1 and map 2 after subtract `map_subtract`
-     */
-    std::map<int, long long int>
-    getMergedMap(const std::map<int, long long int> &map1, const std::map<int, long long int> &map2,
-                 const std::map<int, long long int> &map_subtract);
-
-    /**
-     * simple function to calculate the dissimilarity between two rows (with same lengths)
-     * @param row1 - the first row to compare
-     * @param row2 - the second row to compare
-     * @return the Jaccard distance
-     */
-    float getJaccardDistance(const std::vector<bool> &row1, const std::vector<bool> &row2);
-
-    /**
-     * @param splitted_line_content - line from a workload csv file splitted by ','
-     * @return whether the line describes a block
-     */
-    bool isWorkloadBlockLine(const std::vector<std::string> &splitted_line_content);
-
-    /**
-     * @param splitted_line_content - line from a workload csv file splitted by ','
-     * @return whether the line describes a file
-     */
-    bool isWorkloadFileLine(const std::vector<std::string> &splitted_line_content);
-
-    /**
-     * @param splitted_line_content - block line from a workload csv file splitted by ','
-     * @return return the workload's block sn as described in workload_line
-     */
-    int getWorkloadBlockSN(const std::vector<std::string> &splitted_line_content);
-
-    /**
-     * @param splitted_line_content - file line from a workload csv file splitted by ','
-     * @return return the workload's file sn as described in workload_line
-     */
-    int getWorkloadFileSN(const std::vector<std::string> &splitted_line_content);
-
-    /**
-     * @param splitted_line_content - a line from a workload csv file describing a file splitted by ','
-     * @return return the num of blocks in file as described in workload_line
-     */
-    int getNumOfBlockInFile(const std::vector<std::string> &splitted_line_content);
-
-    /**
-     * @param splitted_line_content - a line from a workload csv file describing a file splitted by ','
-     * @return return the input file of the file (removing the volume prefix - assumes fileId is <vol>_<inputFile>)
-     */
-    std::string getInputFileOfFile(const std::vector<std::string> &splitted_line_content);
-
-    /**
-     * @param splitted_line_content - a line from a workload csv file describing a file splitted by ','
-     * @param block_index - index of the block in the file recipe
-     * @return return the block's SN
-     */
-    int getBlockSNInFileByIndex(const std::vector<std::string> &splitted_line_content, const int block_index);
-
-    /**
-    * @param splitted_line_content - a line from a workload csv file describing a file splitted by ','
-    * @param block_index - index of the block in the file recipe
-    * @return return the block's size
-    */
-    int getBlockSizeInFileByIndex(const std::vector<std::string> &splitted_line_content, const int block_index);
-
-    /**
-     * @param splitted_line_content - a line from a workload csv file splitted by ','
-     * @return return the workload's block fingerprint as described in workload_line
-     */
-    const std::string &getWorkloadBlockFingerprint(const std::vector<std::string> &splitted_line_content);
+     * runs the given work items on up to num_threads threads (the calling thread included), every thread takes the
+     * next work item which was not taken yet. the first exception thrown by a work item stops handing out new work
+     * items and is rethrown once all threads are done
+     * @param num_work_items - num of work items to run
+     * @param num_threads - max num of threads to use
+     * @param work_item_func - function which executes a single work item, given the work item's index and the index
+     * (in [0, num_threads)) of the thread which runs it
+     */
+    void runInParallel(const int num_work_items, const int num_threads,
+                       const std::function<void(const int, const int)> &work_item_func);
+
+    /**
+     * considers the given value for a bounded max heap which keeps the `capacity` smallest values it was given.
+     * the heap's max value is at its front, so a value which is not smaller than it is dropped without touching the heap
+     * @param heap - the heap (as vector), ordered by less
+     * @param capacity - max num of values to keep
+     * @param value - the new value
+     * @param less - strict weak ordering of the values
+     */
+    template<typename T, typename Compare>
+    void updateBoundedMaxHeap(std::vector<T> &heap, const size_t capacity, const T &value, Compare less) {
+        if (heap.size() < capacity) {
+            heap.push_back(value);
+            std::push_heap(heap.begin(), heap.end(), less);
+            return;
+        }
+
+        if (capacity == 0 || !less(value, heap.front()))
+            return;
+
+        // replace the max value
+        std::pop_heap(heap.begin(), heap.end(), less);
+        heap.back() = value;
+        std::push_heap(heap.begin(), heap.end(), less);
+    }
 
     /**
      * @return return current_host_name
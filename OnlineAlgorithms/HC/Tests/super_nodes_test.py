@@ -0,0 +1,195 @@
+import csv
+import glob
+import json
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+NUM_VOLUMES = 4
+NUM_FEW_HOSTS = 2
+NUM_MANY_HOSTS = 8
+NUM_FILES = 60
+NUM_CHANGES = 6
+NUM_FAMILIES = 5
+BLOCK_SIZES = [1000, 2048, 4096, 8192]
+USER = 'U1'
+
+
+def get_fingerprint(rand):
+    return '%040x' % rand.getrandbits(160)
+
+
+def create_system(system_dir, rand, num_hosts):
+    """
+    creates a system of NUM_VOLUMES volumes whose files all belong to num_hosts hosts
+    :return: the volumes paths, the changes input file path, the files index path and the host of every file of the
+    volumes (by the file's sn)
+    """
+    families = [[get_fingerprint(rand) for _ in range(rand.randint(10, 30))] for _ in range(NUM_FAMILIES)]
+    block_to_sn = {}
+    block_to_size = {}
+
+    def get_file_blocks():
+        family = rand.choice(families)
+        return sorted(set(rand.sample(family, rand.randint(len(family) // 2, len(family)))))
+
+    def get_block_sn(block):
+        block_to_size.setdefault(block, rand.choice(BLOCK_SIZES))
+        return block_to_sn.setdefault(block, len(block_to_sn) + 1)
+
+    files_index = {USER: {str(host): [] for host in range(1, num_hosts + 1)}}
+    volumes_files = [[] for _ in range(NUM_VOLUMES)]
+    input_file_to_host = {}
+    for input_file in range(1000, 1000 + NUM_FILES):
+        host = rand.randint(1, num_hosts)
+        volumes_files[rand.randrange(NUM_VOLUMES)].append((input_file, get_file_blocks()))
+        files_index[USER][str(host)].append({'snap_name': f'{USER}_H{host}_IF{input_file}_TS01_01'})
+        input_file_to_host[input_file] = host
+
+    volumes_paths = []
+    file_sn_to_host = {}
+    file_sn = 1
+    for volume, files in enumerate(volumes_files):
+        volume_path = os.path.join(system_dir, f'vol{volume}.csv')
+        volume_blocks = sorted({block for _, blocks in files for block in blocks}, key=get_block_sn)
+        with open(volume_path, 'w') as volume_file:
+            for block in volume_blocks:
+                volume_file.write(f'B, {get_block_sn(block)}, {block}, 1\n')
+            for input_file, blocks in files:
+                blocks_line = ''.join(f', {get_block_sn(block)}, {block_to_size[block]}' for block in blocks)
+                volume_file.write(f'F, {file_sn}, {volume}_{input_file}, {file_sn}, {len(blocks)}{blocks_line}\n')
+                file_sn_to_host[file_sn] = input_file_to_host[input_file]
+                file_sn += 1
+
+        volumes_paths.append(volume_path)
+
+    changes_dir = os.path.join(system_dir, 'changes')
+    os.makedirs(changes_dir)
+    changes_path = os.path.join(system_dir, 'changes.in')
+    with open(changes_path, 'w') as changes_file:
+        for input_file in range(50000, 50000 + NUM_CHANGES):
+            host = rand.randint(1, num_hosts)
+            snap_name = f'{USER}_H{host}_IF{input_file}_TS02_01'
+            files_index[USER][str(host)].append({'snap_name': snap_name})
+
+            blocks = get_file_blocks()
+            change_path = os.path.join(changes_dir, snap_name)
+            with open(change_path, 'w') as change_file:
+                for local_sn, block in enumerate(blocks):
+                    change_file.write(f'B, {local_sn}, {block}, 1\n')
+                blocks_line = ''.join(f', {local_sn}, {block_to_size[block]}' for local_sn, block in enumerate(blocks))
+                change_file.write(f'F, 0, {input_file}, 0, {len(blocks)}{blocks_line}\n')
+
+            changes_file.write(f'add:{change_path},del:\n')
+
+    index_path = os.path.join(system_dir, 'index.json')
+    with open(index_path, 'w') as index_file:
+        json.dump(files_index, index_file)
+
+    return volumes_paths, changes_path, index_path, file_sn_to_host
+
+
+def run_hc(hc_path, system, work_dir, extra_args):
+    """
+    :return: hc's completed process and the directory of its results
+    """
+    volumes_paths, changes_path, index_path, _ = system
+    output_dir = tempfile.mkdtemp(dir=work_dir)
+    command_line = [hc_path, '-workloads', *volumes_paths, '-fps', 'all', '-traffic', '40', '-seed', '0', '37',
+                    '-gap', '0.5', '-wt_list', '0', '100', '-change_pos', 'migration_with_continuous_changes',
+                    '-num_iterations', '2', '-num_changes_iterations', '2', '-changes_input_file', changes_path,
+                    '-changes_perc', '100', '-files_index_path', index_path, '-no_cache',
+                    '-output_path_prefix', os.path.join(output_dir, 'res'), *extra_args]
+    result = subprocess.run(command_line, cwd=output_dir, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    return result, output_dir
+
+
+def get_final_clusters(output_dir):
+    """
+    :return: the final files of every cluster of the last iteration's best result, as sets of file sns
+    """
+    best_iter_paths = sorted(glob.glob(os.path.join(output_dir, 'res_*best_iter_*.csv')),
+                             key=lambda path: int(os.path.basename(path).split('_best_iter_')[1].split('_')[0]))
+    with open(best_iter_paths[-1]) as best_iter_file:
+        rows = list(csv.reader(best_iter_file))
+
+    # the clusters' rows follow the clusters' header, the summed row (without a cluster path) ends them
+    first_cluster_row = next(i for i, row in enumerate(rows) if row and row[0] == 'Cluster path') + 1
+    final_clusters = []
+    for row in rows[first_cluster_row:]:
+        if not row or not row[0]:
+            break
+        final_clusters.append({int(file_sn) for file_sn in row[2].split('-') if file_sn})
+
+    return final_clusters
+
+
+def check_final_clusters(system, output_dir, is_refined):
+    """
+    :return: the errors found in the final clusters of the given run
+    """
+    final_clusters = get_final_clusters(output_dir)
+    errors = []
+    if len(final_clusters) != NUM_VOLUMES:
+        errors.append(f'{len(final_clusters)} clusters instead of {NUM_VOLUMES}')
+
+    if is_refined and any(not final_cluster for final_cluster in final_clusters):
+        errors.append('the refinement left an empty cluster')
+
+    # with at least a host per volume no super node is split, so the files of a host stay together unless they are
+    # refined. only the files of the volumes are checked, the sns of the added files are given by hc
+    file_sn_to_host = system[3]
+    if not is_refined and len(set(file_sn_to_host.values())) >= NUM_VOLUMES:
+        host_to_clusters = {}
+        for cluster_index, final_cluster in enumerate(final_clusters):
+            for file_sn in final_cluster & file_sn_to_host.keys():
+                host_to_clusters.setdefault(file_sn_to_host[file_sn], set()).add(cluster_index)
+
+        for host, clusters in sorted(host_to_clusters.items()):
+            if len(clusters) > 1:
+                errors.append(f'the files of host {host} are in {len(clusters)} clusters')
+
+    return errors
+
+
+def main():
+    hc_path = os.path.abspath(sys.argv[1])
+    failures = []
+    with tempfile.TemporaryDirectory() as work_dir:
+        few_hosts_dir = os.path.join(work_dir, 'few_hosts')
+        os.makedirs(few_hosts_dir)
+        few_hosts_system = create_system(few_hosts_dir, random.Random(7), NUM_FEW_HOSTS)
+        many_hosts_dir = os.path.join(work_dir, 'many_hosts')
+        os.makedirs(many_hosts_dir)
+        many_hosts_system = create_system(many_hosts_dir, random.Random(11), NUM_MANY_HOSTS)
+
+        # with fewer hosts than volumes the super nodes are split up to a super node per volume
+        for system in [few_hosts_system, many_hosts_system]:
+            for extra_args in [['-super_nodes', 'host'],
+                               ['-super_nodes', 'host', '-lb', '-margin', '2', '-eps', '5'],
+                               ['-super_nodes', 'host', '-refine_super_nodes', '-threads', '2']]:
+                run_name = f'{len(set(system[3].values()))} hosts, {" ".join(extra_args)}'
+                result, output_dir = run_hc(hc_path, system, work_dir, extra_args)
+                if result.returncode != 0:
+                    failures.append(f'{run_name}: exit code {result.returncode}\n{result.stdout[-2000:]}')
+                    continue
+
+                for error in check_final_clusters(system, output_dir, '-refine_super_nodes' in extra_args):
+                    failures.append(f'{run_name}: {error}')
+
+        # a threshold of 1 collapses all the files into a single super node
+        result, _ = run_hc(hc_path, few_hosts_system, work_dir, ['-super_nodes', '1'])
+        if result.returncode == 0 or 'jaccard threshold should be' not in result.stdout:
+            failures.append(f'-super_nodes 1: expected to be rejected, exit code {result.returncode}')
+
+    for failure in failures:
+        print(f'FAILED: {failure}')
+
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
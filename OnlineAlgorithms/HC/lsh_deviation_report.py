@@ -0,0 +1,65 @@
+import csv
+import os
+
+from run_exp import get_report_arg_parser, run_report_hc, run_report
+
+DEFAULT_LSH_BANDS = 20
+DEFAULT_LSH_ROWS = 4
+SUMMED_RESULTS_TITLE = 'Summed results:'
+MIGRATION_PLAN_SUFFIX = '_migration_plan.csv'
+
+
+def get_summed_results(output_path_prefix):
+    """
+    :return: the summed results row of the migration plan of the given run as a dict (header -> value)
+    """
+    output_dir = os.path.dirname(output_path_prefix)
+    plan_files = [f for f in os.listdir(output_dir) if f.endswith(MIGRATION_PLAN_SUFFIX)]
+    if len(plan_files) != 1:
+        raise RuntimeError(f'expected a single migration plan in {output_dir}, found {len(plan_files)}')
+
+    with open(os.path.join(output_dir, plan_files[0]), 'r') as plan_file:
+        lines = plan_file.read().splitlines()
+
+    summed_results_index = lines.index(SUMMED_RESULTS_TITLE)
+    headers, values = list(csv.reader(lines[summed_results_index + 1: summed_results_index + 3]))
+    return {header.strip(): float(value) for header, value in zip(headers, values)}
+
+
+def run_hc(args, volumes, output_path_prefix, lsh_args):
+    _, elapsed_time = run_report_hc(args, volumes, output_path_prefix, lsh_args)
+    return get_summed_results(output_path_prefix), elapsed_time
+
+
+def report_workload(args, workload, volumes):
+    output_dir = os.path.join(args.output_dir, workload)
+    exact_results, exact_time = run_hc(args, volumes, os.path.join(output_dir, 'exact', workload), [])
+    lsh_results, lsh_time = run_hc(args, volumes, os.path.join(output_dir, 'lsh', workload),
+                                   ['-lsh_bands', str(args.lsh_bands), '-lsh_rows', str(args.lsh_rows)])
+
+    print(f'{workload} (LSH bands={args.lsh_bands}, rows per band={args.lsh_rows}):')
+    print(f'{"":<16}{"exact":>12}{"lsh":>12}{"deviation":>12}')
+    for header in ['Deletion %', 'Summ traffic%', 'lb_score']:
+        print(f'{header:<16}{exact_results[header]:>12.4f}{lsh_results[header]:>12.4f}'
+              f'{lsh_results[header] - exact_results[header]:>12.4f}')
+
+    print(f'{"run time (s)":<16}{exact_time:>12.1f}{lsh_time:>12.1f}{lsh_time - exact_time:>12.1f}')
+
+
+def get_setup_args():
+    parser = get_report_arg_parser('Runs hc in the exact mode and in the LSH approximate mode on the experiment '
+                                   'systems, and reports how much the final cost deviates', 'lsh_deviation')
+    parser.add_argument('--lsh_bands', dest='lsh_bands', type=int, default=DEFAULT_LSH_BANDS,
+                        help=f'num of LSH bands. default is {DEFAULT_LSH_BANDS}')
+    parser.add_argument('--lsh_rows', dest='lsh_rows', type=int, default=DEFAULT_LSH_ROWS,
+                        help=f'num of min hashes in every LSH band. default is {DEFAULT_LSH_ROWS}')
+
+    return parser.parse_args()
+
+
+def main():
+    run_report(get_setup_args(), report_workload)
+
+
+if __name__ == "__main__":
+    main()
@@ -3,6 +3,7 @@ import sys
 import argparse
 import json
 import os
+import time
 from itertools import product
 from multiprocessing import Pool
 
@@ -18,6 +19,9 @@ CHANGE_POS_OPTIONS = ['only_changes', 'migration_after_changes', 'migration_befo
                       'migration_with_continuous_changes', 'smart_split', 'naive_split', 'lb_split']
 DEFAULT_INDEX_PATH = "filtered_indexed_input_files.json"
 DEFAULT_SPLIT_SORT_ORDER = "soft_lb"
+DEFAULT_REPORT_TRAFFIC = 40
+DEFAULT_REPORT_SEEDS = [0, 37]
+DEFAULT_REPORT_WTS = [0, 20, 40, 60, 100]
 workload_to_conf_map = {
     "ubc150_5vols_by_user": "configs/conf_exp_ubc150_5vols_by_user.json",
     "ubc150_5vols_by_random": "configs/conf_exp_ubc150_5vols_by_random.json",
@@ -76,6 +80,7 @@ def get_hc_command_line(workload_conf, experiment_args, traffic, change_pos, cha
            f'{"-converge_margin" if experiment_args.converge_margin else ""} ' \
            f'{"-use_new_dist_metric" if experiment_args.new_dist_metric else ""} '\
            f'{"-carry_traffic" if experiment_args.carry_traffic else ""} '\
+           f'{f"-snapshot_dir {experiment_args.snapshot_dir}" if experiment_args.snapshot_dir else ""} '\
            f'-split_sort_order {experiment_args.split_sort_order}'
 
 
@@ -91,6 +96,91 @@ def run_in_parallel(workload_conf, experiment_args, traffic, change_seed, change
     print(f'PID={os.getpid()} Done running {command_line}')
 
 
+def get_report_hc_command_line(args, volumes, output_path_prefix, mode_args):
+    """
+    :return: the command line of a single hc run of a report (see get_report_arg_parser) on the given volumes, followed
+    by the report's mode specific flags
+    """
+    return [args.hc_path,
+            '-workloads', *volumes,
+            '-fps', args.fps,
+            '-traffic', str(args.traffic),
+            '-eps', str(args.eps),
+            '-gap', *[str(g) for g in args.gaps],
+            '-seed', *[str(s) for s in args.seeds],
+            '-wt_list', *[str(wt) for wt in args.wts],
+            '-no_cache',
+            '-num_iterations', str(args.num_iterations),
+            '-change_pos', 'migration_before_changes',
+            '-files_index_path', args.files_index_path,
+            '-changes_input_file', args.changes_input_file,
+            '-threads', str(args.threads),
+            '-output_path_prefix', output_path_prefix,
+            *(['-lb'] if args.lb else []),
+            *mode_args]
+
+
+def run_report_hc(args, volumes, output_path_prefix, mode_args):
+    """
+    :return: hc's output and its run time in seconds
+    """
+    os.makedirs(os.path.dirname(output_path_prefix), exist_ok=True)
+    command_line = get_report_hc_command_line(args, volumes, output_path_prefix, mode_args)
+    print(f'Running {" ".join(command_line)}')
+
+    start_time = time.time()
+    output = subprocess.run(command_line, stdout=subprocess.PIPE, check=True, universal_newlines=True).stdout
+    elapsed_time = time.time() - start_time
+
+    return output, elapsed_time
+
+
+def get_report_arg_parser(description, default_output_dir, default_num_iterations=1):
+    """
+    :return: a parser of the arguments shared by the reports which compare hc's modes on the experiment systems, each
+    report adds its mode specific arguments
+    """
+    parser = argparse.ArgumentParser(description=description)
+    parser.add_argument('--hc_path', dest='hc_path', type=str, default='./hc',
+                        help='hc location. default is binary named hc in the current working directory')
+    parser.add_argument('--workloads', dest='workloads', nargs='+', type=str, default=list(workload_to_conf_map.keys()),
+                        help='workloads to run on. default is all of the following - ' + ', '.join(
+                            workload_to_conf_map.keys()))
+    parser.add_argument('--mask', dest='mask', type=str, help='which mask to use, for example "k13". default=no_mask',
+                        default="no_mask")
+    parser.add_argument('--num_iterations', dest='num_iterations', type=int, default=default_num_iterations,
+                        help=f'num of incremental iterations. default is {default_num_iterations}')
+    parser.add_argument('--load_balance', dest='lb', action='store_true', help='Used to enable load balancing feature')
+    parser.add_argument('--traffic', dest='traffic', type=int, default=DEFAULT_REPORT_TRAFFIC,
+                        help=f'traffic for hc. default is {DEFAULT_REPORT_TRAFFIC}')
+    parser.add_argument('--gaps', dest='gaps', nargs='+', type=float, default=DEFAULT_GAPS,
+                        help='gaps for hc. default is ' + ' '.join([str(x) for x in DEFAULT_GAPS]))
+    parser.add_argument('--seeds', dest='seeds', nargs='+', type=int, default=DEFAULT_REPORT_SEEDS,
+                        help='seeds for hc. default is ' + ' '.join([str(x) for x in DEFAULT_REPORT_SEEDS]))
+    parser.add_argument('--wts', dest='wts', nargs='+', type=int, default=DEFAULT_REPORT_WTS,
+                        help='W_Ts for hc. default is ' + ' '.join([str(wt) for wt in DEFAULT_REPORT_WTS]))
+    parser.add_argument('--eps', dest='eps', type=int, default=30, help='eps for hc, default is 30')
+    parser.add_argument('--threads', dest='threads', type=int, default=1, help='num of hc threads, default is 1')
+    parser.add_argument('--files_index_path', dest='files_index_path', type=str, default=DEFAULT_INDEX_PATH,
+                        help=f'path to index json file. default is {DEFAULT_INDEX_PATH}')
+    parser.add_argument('--changes_input_file', dest='changes_input_file', type=str, default='',
+                        help='changes input file, default is ""')
+    parser.add_argument('--output_dir', dest='output_dir', type=str, default=default_output_dir,
+                        help=f'directory of the runs\' results. default is {default_output_dir}')
+
+    return parser
+
+
+def run_report(args, report_workload):
+    """
+    calls report_workload(args, workload, volumes) on each of the report's workloads
+    """
+    for workload in args.workloads:
+        workload_conf = get_workload_conf_file(workload)
+        args.fps = workload_conf['fps_size']
+        report_workload(args, workload, workload_conf['mask_to_volumes_names'][args.mask])
+
+
 def get_setup_args():
     parser = argparse.ArgumentParser(description='Runs hc\'s experiments in parallel')
     parser.add_argument('--load_balance', dest='lb', action='store_true',
@@ -173,6 +263,8 @@ def get_setup_args():
                         help='Used to enable new dist metric feature')
     parser.add_argument('--carry_traffic', dest='carry_traffic', action='store_true',
                         help='Used to enabl carry traffic feature')
+    parser.add_argument('--snapshot_dir', dest='snapshot_dir', type=str, default='',
+                        help='directory of hc\'s ingestion snapshots, shared by all the runs. default is no snapshots')
     parser.set_defaults(load_balance=True, use_cache=True, is_filtered_changes=True,
                         converge_margin=False, new_dist_metric=False, carry_traffic=False)
 
@@ -0,0 +1,61 @@
+import os
+import re
+
+from run_exp import get_report_arg_parser, run_report_hc, run_report
+
+DEFAULT_SWEEP_BUDGETS = [50, 25, 10]
+DEFAULT_NUM_ITERATIONS = 3
+VALIDATION_PATTERN = re.compile(r'the best result was evaluated in (\d+) of (\d+) sweeps')
+
+
+def get_num_surviving_sweeps(output):
+    """
+    :return: (num of sweeps whose best result of the full sweep was evaluated, num of validated sweeps) of the given
+    output of a run with -validate_sweep_budget
+    """
+    matches = VALIDATION_PATTERN.findall(output)
+    if not matches:
+        raise RuntimeError('expected the sweep budget validation in hc\'s output')
+
+    num_surviving_sweeps, num_sweeps = matches[-1]
+    return int(num_surviving_sweeps), int(num_sweeps)
+
+
+def report_workload(args, workload, volumes):
+    output_dir = os.path.join(args.output_dir, workload)
+    _, full_sweep_time = run_report_hc(args, volumes, os.path.join(output_dir, 'full', workload), [])
+
+    rows = []
+    for sweep_budget in args.sweep_budgets:
+        budget_args = ['-sweep_budget', str(sweep_budget)]
+        _, budget_time = run_report_hc(args, volumes, os.path.join(output_dir, f'budget_{sweep_budget}', workload),
+                                       budget_args)
+        validation_output, _ = run_report_hc(args, volumes,
+                                             os.path.join(output_dir, f'validation_{sweep_budget}', workload),
+                                             budget_args + ['-validate_sweep_budget'])
+        rows.append((sweep_budget, budget_time, *get_num_surviving_sweeps(validation_output)))
+
+    print(f'{workload} (full sweep took {full_sweep_time:.1f}s):')
+    print(f'{"budget %":<12}{"run time (s)":>14}{"speedup":>10}{"best survived":>16}')
+    for sweep_budget, budget_time, num_surviving_sweeps, num_sweeps in rows:
+        print(f'{sweep_budget:<12}{budget_time:>14.1f}{full_sweep_time / budget_time:>10.2f}'
+              f'{f"{num_surviving_sweeps}/{num_sweeps}":>16}')
+
+
+def get_setup_args():
+    parser = get_report_arg_parser('Runs hc with the full sweep and with sweep budgets on the experiment systems, and '
+                                   'reports how often the best result of the full sweep survives the budget and how '
+                                   'much faster the runs are', 'sweep_budget', DEFAULT_NUM_ITERATIONS)
+    parser.add_argument('--sweep_budgets', dest='sweep_budgets', nargs='+', type=int, default=DEFAULT_SWEEP_BUDGETS,
+                        help='sweep budgets (in %%) to report. default is ' + ' '.join(
+                            [str(x) for x in DEFAULT_SWEEP_BUDGETS]))
+
+    return parser.parse_args()
+
+
+def main():
+    run_report(get_setup_args(), report_workload)
+
+
+if __name__ == "__main__":
+    main()